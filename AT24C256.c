@@ -3,51 +3,121 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "main.h"
+#include "i2c_async.h"
+#include "AT24C256.h"
+
+// One page write in flight: address + data are copied so the caller's buffer may go away
+static uint8_t write_hdr[2];
+static uint8_t write_data[AT24C256_PAGE_SIZE];
+static i2c_async_txn_t write_txn;
+
+// Acknowledge polling during the internal write cycle: a 1-byte current-address read
+static uint8_t poll_byte;
+static i2c_async_txn_t poll_txn;
+static bool write_cycle = false;
+static absolute_time_t write_deadline;
+
+// Start a write to AT24C256 without waiting for the bus or the write cycle
+bool at24c256_write_start(uint16_t mem_addr, const uint8_t *data, uint8_t len) {
+    if (len > AT24C256_PAGE_SIZE || at24c256_write_busy())
+        return false;
 
-// Write to AT24C256
-bool at24c256_write(uint16_t mem_addr, uint8_t *data, uint8_t len) {
     // Prepare buffer: 2-byte memory address + data
-    uint8_t buffer[2 + len];
-    buffer[0] = (mem_addr >> 8) & 0xFF; // High byte
-    buffer[1] = mem_addr & 0xFF;        // Low byte
-    memcpy(&buffer[2], data, len);
+    write_hdr[0] = (mem_addr >> 8) & 0xFF; // High byte
+    write_hdr[1] = mem_addr & 0xFF;        // Low byte
+    memcpy(write_data, data, len);
 
-    // Write to EEPROM
-    int result = i2c_write_blocking(I2C0_PORT, AT24C256_ADDR, buffer, 2 + len, false);
-    if (result != (2 + len)) {
-        printf("Write failed: %d\n", result);
+    write_txn = (i2c_async_txn_t){
+        .addr = AT24C256_ADDR,
+        .hdr = write_hdr, .hdr_len = 2,
+        .tx = write_data, .tx_len = len,
+        .prio = I2C_ASYNC_PRIO_LOW, .client = I2C0_CLIENT_EEPROM,
+    };
+    if (!i2c_async_submit(I2C0_PORT, &write_txn)) {
+        printf("Write failed: not queued\n");
+        return false;
+    }
+    return true;
+}
+
+// True while the page is queued, on the wire, or being programmed inside the EEPROM
+bool at24c256_write_busy(void) {
+    if (write_txn.status == I2C_ASYNC_QUEUED || write_txn.status == I2C_ASYNC_BUSY)
+        return true;
+
+    if (write_txn.status == I2C_ASYNC_ERROR) {
+        printf("Write failed: not acknowledged\n");
+        write_txn.status = I2C_ASYNC_IDLE;
+        return false;
+    }
+
+    if (write_txn.status == I2C_ASYNC_DONE) {
+        // transfer finished, the chip now needs up to 5 ms
+        write_txn.status = I2C_ASYNC_IDLE;
+        write_cycle = true;
+        write_deadline = make_timeout_time_us(AT24C256_WRITE_TIMEOUT_US);
+        poll_txn.status = I2C_ASYNC_IDLE;
+    }
+
+    if (!write_cycle)
+        return false;
+
+    // The EEPROM does not acknowledge its address until the write cycle is over
+    if (!i2c_async_finished(&poll_txn) && poll_txn.status != I2C_ASYNC_IDLE)
+        return true;
+    if (poll_txn.status == I2C_ASYNC_DONE) {
+        write_cycle = false;
+        return false;
+    }
+    if (absolute_time_diff_us(get_absolute_time(), write_deadline) < 0) {
+        printf("Write timeout\n");
+        write_cycle = false;
+        return false;
+    }
+    poll_txn = (i2c_async_txn_t){
+        .addr = AT24C256_ADDR,
+        .rx = &poll_byte, .rx_len = 1,
+        .prio = I2C_ASYNC_PRIO_LOW, .client = I2C0_CLIENT_EEPROM,
+    };
+    if (!i2c_async_submit(I2C0_PORT, &poll_txn)) {
+        // not queued: nothing to wait for, the next call submits again until write_deadline
+        poll_txn.status = I2C_ASYNC_IDLE;
+    }
+    return true;
+}
+
+// Write to AT24C256 and wait for the internal write cycle
+bool at24c256_write(uint16_t mem_addr, uint8_t *data, uint8_t len) {
+    if (!at24c256_write_start(mem_addr, data, len))
+        return false;
+
+    i2c_async_wait(&write_txn);
+    if (write_txn.status != I2C_ASYNC_DONE) {
+        printf("Write failed: not acknowledged\n");
+        write_txn.status = I2C_ASYNC_IDLE;
         return false;
     }
 
     // Poll for write completion (max 5 ms)
     sleep_ms(1);
-    for (int i = 0; i < 50; i++) {
-        uint8_t dummy = 0;
-        result = i2c_write_blocking(I2C0_PORT, AT24C256_ADDR, &dummy, 1, true);
-        if (result == 1) {
-            return true;
-        }
-        sleep_ms(1);
-    }
-    printf("Write timeout\n");
-    return false;
+    while (at24c256_write_busy())
+        sleep_us(200);
+    return poll_txn.status == I2C_ASYNC_DONE;
 }
 
 // Read from AT24C256
 bool at24c256_read(uint16_t mem_addr, uint8_t *data, uint8_t len) {
-    // Write memory address
+    // Memory address, then repeated start and read
     uint8_t addr_buf[2] = {(mem_addr >> 8) & 0xFF, mem_addr & 0xFF};
-    int result = i2c_write_blocking(I2C0_PORT, AT24C256_ADDR, addr_buf, 2, true);
-    if (result != 2) {
-        printf("Address write failed: %d\n", result);
-        return false;
-    }
-
-    // Read data
-    result = i2c_read_blocking(I2C0_PORT, AT24C256_ADDR, data, len, false);
-    if (result != len) {
-        printf("Read failed: %d\n", result);
+    i2c_async_txn_t txn = {
+        .addr = AT24C256_ADDR,
+        .hdr = addr_buf, .hdr_len = 2,
+        .rx = data, .rx_len = len,
+        .prio = I2C_ASYNC_PRIO_LOW, .client = I2C0_CLIENT_EEPROM,
+    };
+    if (!i2c_async_transfer_blocking(I2C0_PORT, &txn)) {
+        printf("Read failed\n");
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
@@ -1,8 +1,19 @@
 #ifndef AT24C256_H
 #define AT24C256_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AT24C256_PAGE_SIZE 64
+// Datasheet write cycle is 5 ms; allow some margin before giving up
+#define AT24C256_WRITE_TIMEOUT_US 20000
 
 bool at24c256_read(uint16_t mem_addr, uint8_t *data, uint8_t len);
 bool at24c256_write(uint16_t mem_addr, uint8_t *data, uint8_t len);
 
-#endif
\ No newline at end of file
+// Non-blocking page write (len <= AT24C256_PAGE_SIZE, must not cross a page boundary).
+// Data is copied; poll at24c256_write_busy() until it returns false before the next access.
+bool at24c256_write_start(uint16_t mem_addr, const uint8_t *data, uint8_t len);
+bool at24c256_write_busy(void);
+
+#endif
@@ -2,11 +2,18 @@
 #include <stdbool.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "i2c_async.h"
+#include "Si5351.h"
 
 #ifndef SI5351_I2C_ADDR
 #define SI5351_I2C_ADDR 0x60
 #endif
 
+/* Numer klienta w statystykach arbitra I2C0 (I2C0_CLIENT_SI5351 w main.h) */
+#ifndef SI5351_I2C_CLIENT
+#define SI5351_I2C_CLIENT 0
+#endif
+
 /* Rejestry (AN619) */
 #define REG_CLK0_CTRL          16
 #define REG_MS0_P3_15_8        42
@@ -27,7 +34,16 @@
 #define REG_MSNA_P2_15_8       32
 #define REG_MSNA_P2_7_0        33
 
+/* Pozostałe wyjścia i PLLB – bloki sąsiadują, więc zapis może iść jednym burstem */
+#define REG_CLK1_CTRL          17
+#define REG_CLK2_CTRL          18
+#define REG_MSNB_P3_15_8       34
+#define REG_MS1_P3_15_8        50
+#define REG_MS2_P3_15_8        58
+
 #define REG_PLL_RESET          177
+#define PLL_RESET_A            (1u << 5)
+#define PLL_RESET_B            (1u << 7)
 #define REG_OE_CTRL            3
 
 /* Bity w CLKx_CONTROL */
@@ -44,194 +60,838 @@
 #define CLKx_DRIVE_6MA         2u
 #define CLKx_DRIVE_8MA         3u
 
-/* Bity w MS0_P1_MISC (reg 44) */
-#define MSx_DIVBY4_MASK        0x60        /* [7:6] */
+/* Bity w MS0_P1_MISC (reg 44): R w [6:4], DIVBY4 w [3:2], P1[17:16] w [1:0] */
+#define MSx_R_DIV_SHIFT        4
+#define MSx_DIVBY4_MASK        0x0C        /* [3:2] */
 #define MSx_DIVBY4_OFF         0x00
-#define MSx_DIVBY4_ON          0x60        /* 11b => /4 */
+#define MSx_DIVBY4_ON          0x0C        /* 11b => /4 */
 #define MSx_P1_17_16_MASK      0x03
 
 /* Zakresy */
 #define SI5351_MIN_HZ          8000u
 #define SI5351_MAX_HZ          160000000u
 
+/* VCO i dzielniki (AN619) */
+#define SI5351_VCO_MIN_HZ      600000000u
+#define SI5351_VCO_MAX_HZ      900000000u
+#define SI5351_MS_MIN          6u          /* najmniejszy dzielnik całkowity (4 => DIVBY4) */
+#define SI5351_MS_MAX          2048u
+#define SI5351_DIVBY4_MIN_HZ   150000000u
+#define SI5351_FRAC_MAX_C      1048575u    /* 20-bitowe P3 */
+
+/* Dopuszczalny błąd strojenia samym MS0 przy przypiętym VCO */
+#ifndef SI5351_PINNED_MAX_ERR_MHZ
+#define SI5351_PINNED_MAX_ERR_MHZ 1000u
+#endif
+
+/* Ile całkowitych dzielników MS sprawdzić w poszukiwaniu dokładnego PLL */
+#ifndef SI5351_PLAN_MAX_TRIES
+#define SI5351_PLAN_MAX_TRIES  64u
+#endif
+
+/* Czas zatrzaśnięcia PLL po resecie */
+#ifndef SI5351_PLL_SETTLE_US
+#define SI5351_PLL_SETTLE_US   100u
+#endif
+
 /* XTAL */
 #ifndef SI5351_XTAL_HZ
 #define SI5351_XTAL_HZ         25000000u
 #endif
 
+/* Pamięć podręczna planów (LRU) */
+#ifndef SI5351_CACHE_SIZE
+#define SI5351_CACHE_SIZE      8
+#endif
+
 /* Prywatny stan */
 static uint32_t g_clk0_hz = 0;
 
+typedef struct {
+    uint32_t fout_hz;       /* 0 => wpis pusty */
+    uint32_t stamp;         /* znacznik ostatniego użycia */
+    si5351_frac_t pll;      /* PLLA planu – potrzebne przy przypiętym VCO */
+    si5351_clk0_regs_t regs;
+} cache_entry_t;
+
+static cache_entry_t g_cache[SI5351_CACHE_SIZE];
+static uint32_t g_cache_clock = 0;
+static si5351_cache_stats_t g_cache_stats;
+
+/* Aktualne PLLA i tryb stałego VCO */
+static si5351_frac_t g_plla;
+static bool g_plla_valid = false;
+static bool g_vco_pinned = false;
+/* Wyjścia CLK1/CLK2 z si5351_multi_set() taktowane z PLLA – dopóki są, MSNA się nie zmienia */
+static uint8_t g_plla_shared = 0;
+static si5351_tune_path_t g_last_path = SI5351_TUNE_NONE;
+static si5351_tune_stats_t g_tune_stats;
+
+/* Niezmienione bajty w przerwie krótszej niż koszt nowej transakcji (adres + rejestr) są dopisywane do burstu */
+#ifndef SI5351_BURST_GAP
+#define SI5351_BURST_GAP       2u
+#endif
+
+/* Kopia rejestrów w RAM; bit w g_shadow_valid => wartość w układzie jest znana */
+static uint8_t g_shadow[256];
+static uint8_t g_shadow_valid[256 / 8];
+static si5351_bus_stats_t g_bus_stats;
+
 /* I2C helpers */
-static inline bool wr8(uint8_t reg, uint8_t val) {
-    uint8_t b[2] = {reg, val};
-    return i2c_write_blocking(i2c0, SI5351_I2C_ADDR, b, 2, false) == 2;
+/* Najdłuższy burst: MS0..MS2 (42..65) */
+#define SI5351_MAX_BURST       24u
+
+/* Transakcje w locie; jedno strojenie to najwyżej kilka burstów */
+#ifndef SI5351_TXN_POOL
+#define SI5351_TXN_POOL        8u
+#endif
+
+typedef struct {
+    i2c_async_txn_t txn;
+    uint8_t reg;
+    uint8_t data[SI5351_MAX_BURST];
+} si5351_txn_t;
+
+static si5351_txn_t g_txn[SI5351_TXN_POOL];
+static uint32_t g_txn_next = 0;
+static volatile bool g_txn_failed = false;
+
+/* Wołane z przerwania I2C: błąd => zawartość układu nieznana */
+static void txn_done(i2c_async_txn_t *t) {
+    if (t->status != I2C_ASYNC_ERROR) return;
+    g_bus_stats.errors++;
+    g_txn_failed = true;
+    for (uint32_t i = 0; i < sizeof(g_shadow_valid); ++i) g_shadow_valid[i] = 0;
 }
+
+static inline bool txn_in_flight(const si5351_txn_t *slot) {
+    return slot->txn.status == I2C_ASYNC_QUEUED || slot->txn.status == I2C_ASYNC_BUSY;
+}
+
+/* Kolejny slot (po kolei, więc najstarszy); w przerwaniu nie czekamy na zwolnienie */
+static si5351_txn_t *txn_alloc(void) {
+    si5351_txn_t *slot = &g_txn[g_txn_next];
+    if (txn_in_flight(slot)) {
+        if (__get_current_exception()) return NULL;
+        i2c_async_wait(&slot->txn);
+    }
+    g_txn_next = (g_txn_next + 1) % SI5351_TXN_POOL;
+    return slot;
+}
+
+/* Burst do kolejki I2C0 – dane są kopiowane, wynik zapisu znany po si5351_wait() */
 static inline bool wrm(uint8_t reg, const uint8_t *data, uint8_t n) {
-    uint8_t buf[10];
-    if (n > 9) return false;
-    buf[0] = reg;
-    for (uint8_t i = 0; i < n; ++i) buf[1 + i] = data[i];
-    return i2c_write_blocking(i2c0, SI5351_I2C_ADDR, buf, (size_t)n + 1, false) == (int)(n + 1);
+    if (n > SI5351_MAX_BURST) return false;
+    si5351_txn_t *slot = txn_alloc();
+    if (!slot) return false;
+
+    slot->reg = reg;
+    for (uint8_t i = 0; i < n; ++i) slot->data[i] = data[i];
+    slot->txn.addr = SI5351_I2C_ADDR;
+    slot->txn.hdr = &slot->reg;
+    slot->txn.hdr_len = 1;
+    slot->txn.tx = slot->data;
+    slot->txn.tx_len = n;
+    slot->txn.rx = NULL;
+    slot->txn.rx_len = 0;
+    slot->txn.prio = I2C_ASYNC_PRIO_HIGH;  /* syntezer wyprzedza EEPROM */
+    slot->txn.client = SI5351_I2C_CLIENT;
+    slot->txn.callback = txn_done;
+
+    g_bus_stats.transactions++;
+    g_bus_stats.bytes += (uint32_t)n + 1;
+    return i2c_async_submit(i2c0, &slot->txn);
+}
+static inline bool wr8(uint8_t reg, uint8_t val) {
+    return wrm(reg, &val, 1);
 }
 
-/* Wzory AN619 */
-typedef struct {
-    uint32_t P1, P2, P3;
-    bool integer_mode;
-    bool divby4;
-    uint8_t rdiv;   /* 0..7: 0=>/1, 1=>/2, ..., 7=>/128 */
-} ms_params_t;
-
-/* wybór R tak, by MS w 8..2048 */
-static uint8_t choose_rdiv(uint32_t fvco_hz, uint32_t fout_hz) {
-    uint8_t r = 0; // /1
-    while (r < 7) { // do /128
-        uint32_t R = 1u << r;
-        uint64_t ms = (uint64_t)fvco_hz / (fout_hz * R);
-        if (ms >= 8 && ms <= 2048) break;
-        if (ms < 8) break; // już za mało – większe R tylko zmniejszy ms
-        r++;
-    }
-    return r;
-}
-
-static void calc_pll_params(uint32_t fvco_hz, uint32_t fxtal_hz, ms_params_t *o) {
-    /* fvco = a + b/c, gdzie a = floor(fvco/fxtal) */
-    const uint32_t C = 1048576u; /* 2^20 limit to 1,048,575; używamy 2^20 na błąd <1ppm */
-    uint32_t a = fvco_hz / fxtal_hz;
-    uint32_t rem = fvco_hz % fxtal_hz;
-    uint32_t b = (uint32_t)((((uint64_t)rem) * C) / fxtal_hz);
-    uint32_t floor_term = (128u * b) / C;
-    o->P1 = 128u * a + floor_term - 512u;
-    o->P2 = 128u * b - C * floor_term;
-    o->P3 = C;
-    o->integer_mode = (o->P2 == 0);
-    o->divby4 = false;
-}
-
-static void calc_ms_params(uint32_t fvco_hz, uint32_t fout_hz, ms_params_t *o) {
-    /* Dla fout > 150 MHz użyj /4 */
-    if (fout_hz > 150000000u) {
-        o->P1 = 0; o->P2 = 0; o->P3 = 1;
-        o->integer_mode = true;
-        o->divby4 = true;
-        return;
-    }
-    const uint32_t C = 1048576u;
-    /* fvco / fout = a + b/c */
-    uint32_t a = fvco_hz / fout_hz;
-    uint32_t rem = fvco_hz % fout_hz;
-    uint32_t b = (uint32_t)((((uint64_t)rem) * C) / fout_hz);
-    uint32_t floor_term = (128u * b) / C;
-    o->P1 = 128u * a + floor_term - 512u;
-    o->P2 = 128u * b - C * floor_term;
-    o->P3 = C;
-    o->integer_mode = (o->P2 == 0);
-    o->divby4 = false;
-}
-
-/* Zapis parametrów do PLLA (MSNA, reg 26..33) */
-static bool program_plla(const ms_params_t *p) {
-    uint8_t r[8];
-    r[0] = (uint8_t)((p->P3 >> 8) & 0xFF);
-    r[1] = (uint8_t)( p->P3       & 0xFF);
-    r[2] = (uint8_t)((p->P1 >> 16) & 0x03);
-    r[3] = (uint8_t)((p->P1 >> 8)  & 0xFF);
-    r[4] = (uint8_t)( p->P1        & 0xFF);
-    r[5] = (uint8_t)(((p->P3 >> 16) & 0x0F) << 4 | ((p->P2 >> 16) & 0x0F));
-    r[6] = (uint8_t)((p->P2 >> 8)  & 0xFF);
-    r[7] = (uint8_t)( p->P2        & 0xFF);
-    return wrm(REG_MSNA_P3_15_8, r, 8);
-}
-
-/* Zapis parametrów do MS0 (reg 42..49) */
-static bool program_ms0(const ms_params_t *p) {
-    if (p->divby4) {
-        if (!wr8(REG_MS0_P3_15_8, 0x00)) return false;
-        if (!wr8(REG_MS0_P3_7_0, 0x01)) return false;
-        uint8_t p1misc = MSx_DIVBY4_ON | ((p->rdiv & 0x07) << 4); // R w bitach 4-6
-        if (!wr8(REG_MS0_P1_MISC, p1misc)) return false;
-        if (!wr8(REG_MS0_P1_15_8, 0x00)) return false;
-        if (!wr8(REG_MS0_P1_7_0, 0x00)) return false;
-        if (!wr8(REG_MS0_P3_19_16_P2_19_16, 0x10)) return false;
-        if (!wr8(REG_MS0_P2_15_8, 0x00)) return false;
-        if (!wr8(REG_MS0_P2_7_0, 0x00)) return false;
-        return true;
-    } else {
-        uint8_t r[8];
-        r[0] = (uint8_t)((p->P3 >> 8) & 0xFF);
-        r[1] = (uint8_t)(p->P3 & 0xFF);
-        r[2] = (uint8_t)((p->P1 >> 16) & 0x03) | ((p->rdiv & 0x07) << 4); // R w bitach 4-6
-        r[3] = (uint8_t)((p->P1 >> 8) & 0xFF);
-        r[4] = (uint8_t)(p->P1 & 0xFF);
-        r[5] = (uint8_t)(((p->P3 >> 16) & 0x0F) << 4 | ((p->P2 >> 16) & 0x0F));
-        r[6] = (uint8_t)((p->P2 >> 8) & 0xFF);
-        r[7] = (uint8_t)(p->P2 & 0xFF);
-        return wrm(REG_MS0_P3_15_8, r, 8);
+static inline bool shadow_known(uint32_t reg) {
+    return g_shadow_valid[reg >> 3] & (1u << (reg & 7));
+}
+
+static inline void shadow_store(uint32_t reg, uint8_t val) {
+    g_shadow[reg] = val;
+    g_shadow_valid[reg >> 3] |= (uint8_t)(1u << (reg & 7));
+}
+
+static inline bool shadow_differs(uint32_t reg, uint8_t val) {
+    return !shadow_known(reg) || g_shadow[reg] != val;
+}
+
+/* Czy cały blok w układzie jest znany i równy data */
+static bool shadow_matches(uint32_t reg, const uint8_t *data, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i)
+        if (shadow_differs(reg + i, data[i])) return false;
+    return true;
+}
+
+static bool shadow_block_known(uint32_t reg, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i)
+        if (!shadow_known(reg + i)) return false;
+    return true;
+}
+
+/*
+ * Zapis bloku rejestrów przez kopię w RAM: wysyłane są tylko ciągi zmienionych
+ * bajtów, łączone w jeden burst przez krótkie przerwy o znanej zawartości.
+ * *changed (opcjonalnie) => czy którykolwiek bajt bloku się zmienił.
+ */
+static bool reg_write(uint8_t reg, const uint8_t *data, uint8_t n, bool *changed) {
+    uint8_t i = 0;
+    if (changed) *changed = false;
+
+    while (i < n) {
+        if (!shadow_differs(reg + i, data[i])) { ++i; continue; }
+
+        /* początek ciągu; rozszerzaj dopóki kolejne zmiany są w zasięgu SI5351_BURST_GAP */
+        uint8_t start = i, end = i;
+        for (uint8_t j = i + 1; j < n; ++j) {
+            if (shadow_differs(reg + j, data[j])) {
+                bool bridge = true;
+                for (uint8_t k = end + 1; k < j; ++k) bridge &= shadow_known(reg + k);
+                if ((uint32_t)(j - end - 1) > SI5351_BURST_GAP || !bridge) break;
+                end = j;
+            }
+        }
+
+        if (!wrm(reg + start, &data[start], end - start + 1)) {
+            for (uint8_t k = start; k <= end; ++k)
+                g_shadow_valid[(reg + k) >> 3] &= (uint8_t)~(1u << ((reg + k) & 7));
+            return false;
+        }
+        for (uint8_t k = start; k <= end; ++k) shadow_store(reg + k, data[k]);
+        if (changed) *changed = true;
+        i = end + 1;
     }
+    return true;
 }
 
+/* Porównanie a*b z c*d bez przepełnienia (a, c < 2^64, b, d < 2^32) */
+static int cmp_mul(uint64_t a, uint32_t b, uint64_t c, uint32_t d) {
+    uint64_t lo1 = (a & 0xFFFFFFFFu) * b, lo2 = (c & 0xFFFFFFFFu) * d;
+    uint64_t hi1 = (a >> 32) * b + (lo1 >> 32);
+    uint64_t hi2 = (c >> 32) * d + (lo2 >> 32);
+    if (hi1 != hi2) return hi1 < hi2 ? -1 : 1;
+    lo1 &= 0xFFFFFFFFu; lo2 &= 0xFFFFFFFFu;
+    return lo1 < lo2 ? -1 : (lo1 > lo2);
+}
 
-bool si5351_clk0_set(uint32_t fout_hz) {
+static uint64_t gcd64(uint64_t a, uint64_t b) {
+    while (b) { uint64_t t = a % b; a = b; b = t; }
+    return a;
+}
+
+/* |num/den - p/q| * den * q; różnica jest mała, więc arytmetyka modulo 2^64 daje dokładny wynik */
+static uint64_t approx_err(uint64_t num, uint64_t den, uint64_t p, uint64_t q) {
+    int64_t e = (int64_t)(num * q - p * den);
+    return (uint64_t)(e < 0 ? -e : e);
+}
+
+/*
+ * Najlepsze przybliżenie num/den w postaci a + b/c, c <= max_c.
+ * Ułamki łańcuchowe: ostatni redukt mieszczący się w max_c porównywany
+ * z największym reduktem pośrednim (semiconvergent).
+ */
+static void best_rational(uint64_t num, uint64_t den, uint32_t max_c, si5351_frac_t *o) {
+    uint64_t g = gcd64(num, den);
+    num /= g; den /= g;
+
+    o->a = (uint32_t)(num / den);
+    uint64_t r = num % den;
+    if (r == 0) { o->b = 0; o->c = 1; return; }
+    if (den <= max_c) { o->b = (uint32_t)r; o->c = (uint32_t)den; return; }
+
+    uint64_t p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    uint64_t n = r, d = den;
+    while (d != 0) {
+        uint64_t t = n / d;
+        uint64_t q2 = q0 + t * q1;
+        if (q2 > max_c) {
+            uint64_t k = (max_c - q0) / q1;
+            uint64_t ps = p0 + k * p1, qs = q0 + k * q1;
+            if (k > 0 &&
+                cmp_mul(approx_err(r, den, ps, qs), (uint32_t)q1,
+                        approx_err(r, den, p1, q1), (uint32_t)qs) < 0) {
+                p1 = ps; q1 = qs;
+            }
+            break;
+        }
+        uint64_t p2 = p0 + t * p1;
+        p0 = p1; q0 = q1; p1 = p2; q1 = q2;
+        uint64_t nd = n - t * d;
+        n = d; d = nd;
+    }
+
+    /* przybliżenie może zaokrąglić się w górę do pełnej jedności */
+    if (p1 == q1) { o->a++; o->b = 0; o->c = 1; return; }
+    o->b = (uint32_t)p1;
+    o->c = (uint32_t)q1;
+}
+
+static uint64_t div_round(uint64_t n, uint64_t d) {
+    return (n + d / 2) / d;
+}
+
+/* Osiągnięta częstotliwość wyjściowa w mHz dla danego planu */
+static uint64_t plan_fout_mhz(const si5351_frac_t *pll, const si5351_frac_t *ms, uint32_t R) {
+    uint64_t fvco_mhz = div_round((uint64_t)SI5351_XTAL_HZ * 1000u *
+                                  ((uint64_t)pll->a * pll->c + pll->b), pll->c);
+    return div_round(fvco_mhz * ms->c, ((uint64_t)ms->a * ms->c + ms->b) * R);
+}
+
+static void plan_finish(si5351_plan_t *plan, uint32_t fout_hz) {
+    plan->achieved_mhz = plan_fout_mhz(&plan->pll, &plan->ms, 1u << plan->rdiv);
+    plan->error_mhz = (int32_t)((int64_t)plan->achieved_mhz - (int64_t)fout_hz * 1000);
+}
+
+static uint32_t abs_err(const si5351_plan_t *p) {
+    return (uint32_t)(p->error_mhz < 0 ? -p->error_mhz : p->error_mhz);
+}
+
+bool si5351_plan(uint32_t fout_hz, si5351_plan_t *plan) {
     if (fout_hz < SI5351_MIN_HZ || fout_hz > SI5351_MAX_HZ) return false;
 
-    uint32_t fvco_hz = 0;
-    uint32_t div = 0;
-    bool force_integer = false;
+    /* Powyżej 150 MHz tylko MS = 4 (DIVBY4) */
+    if (fout_hz > SI5351_DIVBY4_MIN_HZ) {
+        plan->rdiv = 0;
+        plan->divby4 = true;
+        plan->ms.a = 4; plan->ms.b = 0; plan->ms.c = 1;
+        best_rational((uint64_t)fout_hz * 4, SI5351_XTAL_HZ, SI5351_FRAC_MAX_C, &plan->pll);
+        plan_finish(plan, fout_hz);
+        return true;
+    }
+
+    /* Najmniejszy R, przy którym MS <= 2048 wystarcza do osiągnięcia VCO */
     uint8_t rdiv = 0;
+    while (rdiv < 7 && (uint64_t)fout_hz * (1u << rdiv) * SI5351_MS_MAX < SI5351_VCO_MIN_HZ) rdiv++;
+    uint32_t fr = fout_hz << rdiv;
+
+    uint32_t m_min = (SI5351_VCO_MIN_HZ + fr - 1) / fr;
+    uint32_t m_max = SI5351_VCO_MAX_HZ / fr;
+    if (m_min < SI5351_MS_MIN) m_min = SI5351_MS_MIN;
+    if (m_max > SI5351_MS_MAX) m_max = SI5351_MS_MAX;
+    if (m_min > m_max) return false;
 
-    /* Wybór R dzielnika dla niskich częstotliwości */
-    if (fout_hz < 500000) {
-        rdiv = 7; // Start z /128
-        uint32_t R = 1u << rdiv;
-        uint64_t ms_numerator = (uint64_t)900000000 / fout_hz; // Maksymalne VCO / fout
-        while (rdiv > 0 && (ms_numerator / R < 8 || ms_numerator / R > 2048)) {
-            rdiv--;
-            R = 1u << rdiv;
+    plan->rdiv = rdiv;
+    plan->divby4 = false;
+
+    /* 1) Parzysty całkowity MS i PLL dokładny w 20 bitach – najlepszy jitter, błąd zerowy */
+    uint32_t m_first_even = m_min + (m_min & 1u);
+    uint32_t tries = 0;
+    for (uint32_t m = m_first_even; m <= m_max && tries < SI5351_PLAN_MAX_TRIES; m += 2, ++tries) {
+        uint64_t fvco = (uint64_t)fr * m;
+        if (SI5351_XTAL_HZ / gcd64(fvco, SI5351_XTAL_HZ) <= SI5351_FRAC_MAX_C) {
+            plan->ms.a = m; plan->ms.b = 0; plan->ms.c = 1;
+            best_rational(fvco, SI5351_XTAL_HZ, SI5351_FRAC_MAX_C, &plan->pll);
+            plan_finish(plan, fout_hz);
+            return true;
         }
     }
 
-    /* Szukanie VCO z uwzględnieniem R dzielnika */
-    uint32_t R = 1u << rdiv;
-    uint32_t target_fout = fout_hz * R; // Skorygowana częstotliwość wejściowa
-    for (uint32_t n = 6; n <= 1800; n++) {
-        uint64_t cand = (uint64_t)target_fout * n;
-        if (cand >= 600000000ULL && cand <= 900000000ULL) {
-            fvco_hz = (uint32_t)cand;
-            div = n;
-            break;
+    /* 2) Całkowity MS, ułamkowy PLL przybliżony reduktami */
+    si5351_plan_t best;
+    best.rdiv = rdiv;
+    best.divby4 = false;
+    best.ms.a = m_first_even <= m_max ? m_first_even : m_min;
+    best.ms.b = 0; best.ms.c = 1;
+    best_rational((uint64_t)fr * best.ms.a, SI5351_XTAL_HZ, SI5351_FRAC_MAX_C, &best.pll);
+    plan_finish(&best, fout_hz);
+
+    /* 3) Całkowity PLL (N * XTAL), ułamkowy MS – wybierz mniejszy błąd */
+    for (uint32_t n = (SI5351_VCO_MIN_HZ + SI5351_XTAL_HZ - 1) / SI5351_XTAL_HZ;
+         (uint64_t)n * SI5351_XTAL_HZ <= SI5351_VCO_MAX_HZ && best.error_mhz != 0; ++n) {
+        uint64_t fvco = (uint64_t)n * SI5351_XTAL_HZ;
+        if (fvco < (uint64_t)fr * 8u || fvco > (uint64_t)fr * SI5351_MS_MAX) continue;
+
+        si5351_plan_t cand;
+        cand.rdiv = rdiv;
+        cand.divby4 = false;
+        cand.pll.a = n; cand.pll.b = 0; cand.pll.c = 1;
+        best_rational(fvco, fr, SI5351_FRAC_MAX_C, &cand.ms);
+        plan_finish(&cand, fout_hz);
+        if (abs_err(&cand) < abs_err(&best)) best = cand;
+    }
+
+    *plan = best;
+    return true;
+}
+
+/* P1/P2/P3 z a + b/c (AN619, rozdz. 3.2 i 4.1.2) */
+static void frac_to_p(const si5351_frac_t *f, uint32_t *P1, uint32_t *P2, uint32_t *P3) {
+    uint32_t floor_term = (uint32_t)(((uint64_t)128u * f->b) / f->c);
+    *P1 = 128u * f->a + floor_term - 512u;
+    *P2 = 128u * f->b - f->c * floor_term;
+    *P3 = f->c;
+}
+
+/* Obraz 8 rejestrów dzielnika (MSNx albo MSx); misc trafia do bitów [7:2] trzeciego bajtu */
+static void encode_ms(uint32_t P1, uint32_t P2, uint32_t P3, uint8_t misc, uint8_t r[8]) {
+    r[0] = (uint8_t)((P3 >> 8) & 0xFF);
+    r[1] = (uint8_t)( P3       & 0xFF);
+    r[2] = (uint8_t)((P1 >> 16) & MSx_P1_17_16_MASK) | misc;
+    r[3] = (uint8_t)((P1 >> 8)  & 0xFF);
+    r[4] = (uint8_t)( P1        & 0xFF);
+    r[5] = (uint8_t)(((P3 >> 16) & 0x0F) << 4 | ((P2 >> 16) & 0x0F));
+    r[6] = (uint8_t)((P2 >> 8)  & 0xFF);
+    r[7] = (uint8_t)( P2        & 0xFF);
+}
+
+/* Obraz rejestrów MSNA (26..33) */
+static void encode_plla(const si5351_frac_t *f, uint8_t r[8]) {
+    uint32_t P1, P2, P3;
+    frac_to_p(f, &P1, &P2, &P3);
+    encode_ms(P1, P2, P3, 0, r);
+}
+
+/* Obraz rejestrów MSx (MS0: 42..49, MS1: 50..57, MS2: 58..65) */
+static void encode_msx(const si5351_plan_t *plan, uint8_t r[8]) {
+    uint8_t misc = (uint8_t)((plan->rdiv & 0x07) << MSx_R_DIV_SHIFT);
+    if (plan->divby4) {
+        /* DIVBY4: P1 = P2 = 0, P3 = 1 */
+        encode_ms(0, 0, 1, misc | MSx_DIVBY4_ON, r);
+    } else {
+        uint32_t P1, P2, P3;
+        frac_to_p(&plan->ms, &P1, &P2, &P3);
+        encode_ms(P1, P2, P3, misc, r);
+    }
+}
+
+/* Zapis gotowego obrazu przez kopię rejestrów; reset PLL tylko gdy zmieniło się MSNA */
+static bool program_clk0(const si5351_clk0_regs_t *regs, bool *pll_reset) {
+    bool pll_changed;
+    if (!reg_write(REG_MSNA_P3_15_8, regs->msna, 8, &pll_changed)) return false;
+    if (!reg_write(REG_MS0_P3_15_8, regs->ms0, 8, NULL)) return false;
+    if (!reg_write(REG_CLK0_CTRL, &regs->clk0, 1, NULL)) return false;
+
+    /* włącz tylko CLK0; pozostałe wyjścia zostają tak, jak ustawił je si5351_multi_set() */
+    const uint8_t oe = (shadow_known(REG_OE_CTRL) ? g_shadow[REG_OE_CTRL] : 0xFF) & (uint8_t)~0x01u;
+    if (!reg_write(REG_OE_CTRL, &oe, 1, NULL)) return false;
+
+    /* rejestr 177 sam się zeruje – nie trafia do kopii; PLLB należy do si5351_multi_set() */
+    if (pll_changed && !wr8(REG_PLL_RESET, PLL_RESET_A)) return false;
+    *pll_reset = pll_changed;
+    return true;
+}
+
+/* Wyszukiwanie w pamięci podręcznej; trafienie odświeża znacznik LRU */
+static const cache_entry_t *cache_lookup(uint32_t fout_hz) {
+    for (uint32_t i = 0; i < SI5351_CACHE_SIZE; ++i) {
+        if (g_cache[i].fout_hz == fout_hz) {
+            g_cache[i].stamp = ++g_cache_clock;
+            return &g_cache[i];
         }
     }
+    return NULL;
+}
+
+/* Wstawienie w miejsce pustego lub najdawniej użytego wpisu */
+static void cache_insert(uint32_t fout_hz, const si5351_frac_t *pll, const si5351_clk0_regs_t *regs) {
+    cache_entry_t *victim = &g_cache[0];
+    for (uint32_t i = 0; i < SI5351_CACHE_SIZE; ++i) {
+        if (g_cache[i].fout_hz == 0) { victim = &g_cache[i]; break; }
+        if (g_cache[i].stamp < victim->stamp) victim = &g_cache[i];
+    }
+    victim->fout_hz = fout_hz;
+    victim->stamp = ++g_cache_clock;
+    victim->pll = *pll;
+    victim->regs = *regs;
+}
 
-    if (div == 0) return false;
+void si5351_clk0_build(const si5351_plan_t *plan, si5351_clk0_regs_t *regs) {
+    encode_plla(&plan->pll, regs->msna);
+    encode_msx(plan, regs->ms0);
 
-    ms_params_t pll, ms;
-    calc_pll_params(fvco_hz, SI5351_XTAL_HZ, &pll);
-    calc_ms_params(fvco_hz, target_fout, &ms); // Użyj skorygowanej częstotliwości
-    ms.rdiv = rdiv; // Przekaż R dzielnik
+    /* Tryb całkowity MS tylko dla parzystego dzielnika bez części ułamkowej */
+    regs->clk0 = CLKx_SRC_MS | CLKx_DRIVE_8MA;
+    if (plan->ms.b == 0 && (plan->ms.a & 1u) == 0) regs->clk0 |= CLKx_INT;
+}
+
+bool si5351_clk0_calc(uint32_t fout_hz, si5351_clk0_regs_t *regs) {
+    si5351_plan_t plan;
+    if (!si5351_plan(fout_hz, &plan)) return false;
+    si5351_clk0_build(&plan, regs);
+    return true;
+}
 
-    if (fout_hz < 500000) {
-        ms.integer_mode = true;
-        ms.P2 = 0;
-        ms.P3 = 1;
+bool si5351_plan_from_vco(const si5351_frac_t *pll, uint32_t fout_hz, si5351_plan_t *plan) {
+    /* DIVBY4 wymaga VCO = 4 * fout, więc nie da się go osiągnąć samym MS */
+    if (fout_hz < SI5351_MIN_HZ || fout_hz > SI5351_DIVBY4_MIN_HZ) return false;
+
+    /* fvco / fxtal = pll_num / pll->c */
+    uint64_t pll_num = (uint64_t)pll->a * pll->c + pll->b;
+    uint64_t fvco_hz = (uint64_t)SI5351_XTAL_HZ * pll_num / pll->c;
+
+    uint8_t rdiv = 0;
+    while (rdiv < 7 && ((uint64_t)fout_hz << rdiv) * SI5351_MS_MAX < fvco_hz) rdiv++;
+    uint64_t fr = (uint64_t)fout_hz << rdiv;
+
+    plan->pll = *pll;
+    plan->rdiv = rdiv;
+    plan->divby4 = false;
+    best_rational((uint64_t)SI5351_XTAL_HZ * pll_num, (uint64_t)pll->c * fr, SI5351_FRAC_MAX_C, &plan->ms);
+
+    /* MS: całkowite 6..2048 albo ułamkowe 8 + 1/c .. 2048 */
+    const si5351_frac_t *ms = &plan->ms;
+    if (ms->b == 0 ? (ms->a < SI5351_MS_MIN || ms->a > SI5351_MS_MAX)
+                   : (ms->a < 8 || ms->a >= SI5351_MS_MAX)) return false;
+
+    plan_finish(plan, fout_hz);
+    return abs_err(plan) <= SI5351_PINNED_MAX_ERR_MHZ;
+}
+
+bool si5351_wait(void) {
+    for (uint32_t i = 0; i < SI5351_TXN_POOL; ++i) i2c_async_wait(&g_txn[i].txn);
+    bool ok = !g_txn_failed;
+    g_txn_failed = false;
+    return ok;
+}
+
+bool si5351_busy(void) {
+    for (uint32_t i = 0; i < SI5351_TXN_POOL; ++i)
+        if (txn_in_flight(&g_txn[i])) return true;
+    return false;
+}
+
+/* Wspólna część si5351_clk0_set() i si5351_clk0_set_async(); *pll_reset => PLL w trakcie zatrzaskiwania */
+static bool clk0_tune(uint32_t fout_hz, bool *pll_reset) {
+    if (fout_hz < SI5351_MIN_HZ || fout_hz > SI5351_MAX_HZ) return false;
+
+    si5351_clk0_regs_t regs;
+    si5351_frac_t pll;
+    si5351_tune_path_t path;
+    si5351_plan_t plan;
+
+    bool keep_vco = g_vco_pinned || g_plla_shared;
+    if (keep_vco && g_plla_valid && si5351_plan_from_vco(&g_plla, fout_hz, &plan)) {
+        /* Przypięte albo wspólne VCO: MSNA bez zmian, więc program_clk0 nie resetuje PLL */
+        si5351_clk0_build(&plan, &regs);
+        pll = g_plla;
+        path = SI5351_TUNE_MS_ONLY;
+    } else if (g_plla_shared) {
+        /* nowe MSNA przestroiłoby też CLK1/CLK2 */
+        return false;
+    } else {
+        const cache_entry_t *hit = cache_lookup(fout_hz);
+        if (hit) {
+            g_cache_stats.hits++;
+            regs = hit->regs;
+            pll = hit->pll;
+        } else {
+            g_cache_stats.misses++;
+            if (!si5351_plan(fout_hz, &plan)) return false;
+            si5351_clk0_build(&plan, &regs);
+            pll = plan.pll;
+            cache_insert(fout_hz, &pll, &regs);
+        }
+        path = SI5351_TUNE_FULL;
     }
 
-    if (!program_plla(&pll)) return false;
-    if (!program_ms0(&ms)) return false;
+    if (!program_clk0(&regs, pll_reset)) {
+        g_plla_valid = false;
+        return false;
+    }
 
-    uint8_t clk0 = CLKx_SRC_MS | CLKx_DRIVE_8MA;
-    if (ms.integer_mode) clk0 |= CLKx_INT;
-    if (!wr8(REG_CLK0_CTRL, clk0)) return false;
+    g_plla = pll;
+    g_plla_valid = true;
+    g_last_path = path;
+    if (path == SI5351_TUNE_MS_ONLY) g_tune_stats.ms_only++;
+    else g_tune_stats.full++;
+    if (*pll_reset) g_tune_stats.pll_resets++;
 
-    if (!wr8(REG_OE_CTRL, 0x00)) return false;
-    if (!wr8(REG_PLL_RESET, 0xA0)) return false;
+    g_clk0_hz = fout_hz;
+    return true;
+}
+
+bool si5351_finish(bool pll_reset) {
+    if (!si5351_wait()) return false;
+    if (pll_reset) sleep_us(SI5351_PLL_SETTLE_US);
+    return true;
+}
+
+bool si5351_clk0_set(uint32_t fout_hz) {
+    bool pll_reset;
+    return clk0_tune(fout_hz, &pll_reset) && si5351_finish(pll_reset);
+}
+
+bool si5351_clk0_set_async(uint32_t fout_hz, bool *pll_reset) {
+    bool reset;
+    if (!clk0_tune(fout_hz, &reset)) return false;
+    if (pll_reset) *pll_reset = reset;
+    return true;
+}
 
+bool si5351_clk0_apply(const si5351_clk0_regs_t *regs, uint32_t fout_hz, bool *pll_reset) {
+    bool reset;
+    /* obraz z innym MSNA przestroiłby też CLK1/CLK2 na PLLA */
+    if (g_plla_shared && !shadow_matches(REG_MSNA_P3_15_8, regs->msna, 8)) return false;
+    if (!program_clk0(regs, &reset)) {
+        g_plla_valid = false;
+        return false;
+    }
+    /* Obraz nie niesie ułamka PLLA – po zmianie MSNA przypięte VCO jest nieznane */
+    if (reset) g_plla_valid = false;
     g_clk0_hz = fout_hz;
-    sleep_us(100);
+    if (pll_reset) *pll_reset = reset;
+    return true;
+}
+
+void si5351_vco_pin(void) {
+    g_vco_pinned = true;
+}
+
+void si5351_vco_unpin(void) {
+    g_vco_pinned = false;
+}
+
+bool si5351_vco_is_pinned(void) {
+    return g_vco_pinned;
+}
+
+si5351_tune_path_t si5351_last_tune_path(void) {
+    return g_last_path;
+}
+
+void si5351_tune_get_stats(si5351_tune_stats_t *stats) {
+    *stats = g_tune_stats;
+}
+
+static bool same_frac(const si5351_frac_t *x, const si5351_frac_t *y) {
+    return x->a == y->a && x->b == y->b && x->c == y->c;
+}
+
+/* Czy wyjście da się zasilić z gotowego VCO całkowitym dzielnikiem (dokładnie) */
+static bool plan_integer_from(const si5351_plan_t *own, const si5351_frac_t *pll, uint32_t fout_hz,
+                              si5351_plan_t *plan) {
+    if (same_frac(&own->pll, pll)) {
+        *plan = *own;
+        return plan->ms.b == 0 && plan->error_mhz == 0;
+    }
+    return si5351_plan_from_vco(pll, fout_hz, plan) && plan->ms.b == 0 && plan->error_mhz == 0;
+}
+
+/*
+ * Wspólne VCO dla wyjść z maski: najmniejsza wielokrotność NWW (f * R) w zakresie
+ * z dokładnym PLL; even => wszystkie MS parzyste (tryb całkowity, najmniejszy jitter).
+ */
+static bool lcm_vco(const si5351_plan_t own[SI5351_NUM_OUTPUTS], const uint32_t fout_hz[SI5351_NUM_OUTPUTS],
+                    uint8_t mask, bool even, si5351_frac_t *pll) {
+    uint64_t l = 1;
+    for (uint8_t i = 0; i < SI5351_NUM_OUTPUTS; ++i) {
+        if (!(mask & (1u << i))) continue;
+        uint64_t fr = ((uint64_t)fout_hz[i] << own[i].rdiv) * (even ? 2u : 1u);
+        l = l / gcd64(l, fr) * fr;
+        if (l > SI5351_VCO_MAX_HZ) return false;
+    }
+    uint32_t tries = 0;
+    for (uint64_t v = ((SI5351_VCO_MIN_HZ + l - 1) / l) * l;
+         v <= SI5351_VCO_MAX_HZ && tries < SI5351_PLAN_MAX_TRIES; v += l, ++tries) {
+        if (SI5351_XTAL_HZ / gcd64(v, SI5351_XTAL_HZ) <= SI5351_FRAC_MAX_C) {
+            best_rational(v, SI5351_XTAL_HZ, SI5351_FRAC_MAX_C, pll);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Czy wyjście w ogóle da się zasilić z VCO (także ułamkowym MS) */
+static bool reachable(const si5351_plan_t *own, const si5351_frac_t *pll, uint32_t fout_hz) {
+    si5351_plan_t tmp;
+    return same_frac(&own->pll, pll) || si5351_plan_from_vco(pll, fout_hz, &tmp);
+}
+
+/* Czy wyjścia z maski stuck zmieszczą się na jednej, jeszcze wolnej PLL */
+static bool one_pll_left(const si5351_plan_t own[SI5351_NUM_OUTPUTS], const uint32_t fout_hz[SI5351_NUM_OUTPUTS],
+                         uint8_t stuck) {
+    if (!stuck) return true;
+    for (uint8_t k = 0; k < SI5351_NUM_OUTPUTS; ++k) {
+        if (!(stuck & (1u << k))) continue;
+        bool all = true;
+        for (uint8_t j = 0; j < SI5351_NUM_OUTPUTS && all; ++j)
+            if (stuck & (1u << j)) all = reachable(&own[j], &own[k].pll, fout_hz[j]);
+        if (all) return true;
+    }
+    return false;
+}
+
+/*
+ * Wybór VCO dla jednej PLL: kandydaci to własne plany wyjść z maski pending
+ * oraz wspólne wielokrotności ich częstotliwości. Wygrywa VCO, z którego
+ * najwięcej wyjść dostaje całkowity MS; *shared => te wyjścia. Kandydat nie może
+ * zostawić wyjścia, którego nie zasili ani on, ani other (PLLA dla PLLB), ani
+ * pozostała PLL. Gdy żadne nie ma dokładnego MS, *shared => wyjście, którego
+ * to własne VCO.
+ */
+static void pick_vco(const si5351_plan_t own[SI5351_NUM_OUTPUTS], const uint32_t fout_hz[SI5351_NUM_OUTPUTS],
+                     uint8_t pending, const si5351_frac_t *other, si5351_frac_t *pll, uint8_t *shared) {
+    si5351_frac_t cand[SI5351_NUM_OUTPUTS + 8];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SI5351_NUM_OUTPUTS; ++i)
+        if (pending & (1u << i)) cand[n++] = own[i].pll;
+    /* trójka i pary; przy remisie wygrywa wcześniejszy kandydat, więc najpierw parzyste MS */
+    static const uint8_t groups[] = {0x07, 0x03, 0x05, 0x06};
+    for (uint8_t g = 0; g < sizeof(groups); ++g) {
+        if ((groups[g] & pending) != groups[g]) continue;
+        if (lcm_vco(own, fout_hz, groups[g], true, &cand[n])) ++n;
+        else if (lcm_vco(own, fout_hz, groups[g], false, &cand[n])) ++n;
+    }
+
+    /* najpierw tylko kandydaci, po których wszystko da się jeszcze zasilić */
+    int best_score = -1;
+    for (int strict = 1; strict >= 0 && best_score < 0; --strict) {
+        for (uint8_t c = 0; c < n; ++c) {
+            uint8_t mask = 0, owner = 0, stuck = 0;
+            int score = 0;
+            for (uint8_t j = 0; j < SI5351_NUM_OUTPUTS; ++j) {
+                if (!(pending & (1u << j))) continue;
+                si5351_plan_t tmp;
+                if (plan_integer_from(&own[j], &cand[c], fout_hz[j], &tmp)) {
+                    mask |= (uint8_t)(1u << j);
+                    ++score;
+                    continue;
+                }
+                if (same_frac(&own[j].pll, &cand[c])) owner |= (uint8_t)(1u << j);
+                if (!reachable(&own[j], &cand[c], fout_hz[j]) && !(other && reachable(&own[j], other, fout_hz[j])))
+                    stuck |= (uint8_t)(1u << j);
+            }
+            if (strict && (other ? stuck != 0 : !one_pll_left(own, fout_hz, stuck))) continue;
+            if (score > best_score) {
+                best_score = score;
+                *pll = cand[c];
+                *shared = mask ? mask : (uint8_t)(owner & -owner);
+            }
+        }
+    }
+}
+
+bool si5351_multi_plan(const uint32_t fout_hz[SI5351_NUM_OUTPUTS], si5351_multi_plan_t *mp) {
+    si5351_plan_t own[SI5351_NUM_OUTPUTS];
+    uint8_t pending = 0;
+
+    for (uint8_t i = 0; i < SI5351_NUM_OUTPUTS; ++i) {
+        mp->enabled[i] = fout_hz[i] != 0;
+        mp->src[i] = 0;
+        if (!mp->enabled[i]) continue;
+        if (!si5351_plan(fout_hz[i], &own[i])) return false;
+        pending |= (uint8_t)(1u << i);
+    }
+    mp->pll_used[0] = mp->pll_used[1] = false;
+
+    /* PLLA, potem PLLB: każda dostaje VCO, które daje najwięcej całkowitych MS */
+    for (uint8_t pll = 0; pll < 2 && pending; ++pll) {
+        uint8_t shared = 0;
+        pick_vco(own, fout_hz, pending, pll ? &mp->pll[0] : NULL, &mp->pll[pll], &shared);
+        mp->pll_used[pll] = true;
+        for (uint8_t j = 0; j < SI5351_NUM_OUTPUTS; ++j) {
+            if (!(shared & (1u << j))) continue;
+            /* bez dokładnego MS: własny plan wyjścia, którego to VCO */
+            if (!plan_integer_from(&own[j], &mp->pll[pll], fout_hz[j], &mp->out[j])) mp->out[j] = own[j];
+            mp->src[j] = pll;
+        }
+        pending &= (uint8_t)~shared;
+    }
+
+    /* Trzecie wyjście bez wspólnego całkowitego VCO: ułamkowy MS z PLL o mniejszym błędzie */
+    for (uint8_t j = 0; j < SI5351_NUM_OUTPUTS; ++j) {
+        if (!(pending & (1u << j))) continue;
+        bool found = false;
+        for (uint8_t pll = 0; pll < 2; ++pll) {
+            si5351_plan_t cand;
+            if (!si5351_plan_from_vco(&mp->pll[pll], fout_hz[j], &cand)) continue;
+            if (!found || abs_err(&cand) < abs_err(&mp->out[j])) {
+                mp->out[j] = cand;
+                mp->src[j] = pll;
+                found = true;
+            }
+        }
+        if (!found) return false;
+    }
     return true;
 }
 
+bool si5351_multi_set(const uint32_t fout_hz[SI5351_NUM_OUTPUTS]) {
+    si5351_multi_plan_t mp;
+    if (!si5351_multi_plan(fout_hz, &mp)) return false;
+
+    /* Bloki sąsiadujących rejestrów: MSNA+MSNB (26..41), MS0..MS2 (42..65), CLK0..2 (16..18) */
+    uint8_t plls[16], ms[24], clk[SI5351_NUM_OUTPUTS];
+    uint8_t oe = 0xFF;
+    uint8_t defined = 0;    /* wyjścia, których 8 bajtów MS jest określonych */
+    uint8_t shared = 0;     /* CLK1/CLK2 na PLLA */
+    for (uint8_t pll = 0; pll < 2; ++pll) {
+        if (mp.pll_used[pll]) encode_plla(&mp.pll[pll], &plls[8 * pll]);
+    }
+    for (uint8_t i = 0; i < SI5351_NUM_OUTPUTS; ++i) {
+        if (!mp.enabled[i]) {
+            /* wyłączone wyjście: bez zmian względem układu, o ile jego MS jest znany */
+            clk[i] = CLKx_PDN;
+            if (!shadow_block_known(REG_MS0_P3_15_8 + 8 * i, 8)) continue;
+            for (uint8_t k = 0; k < 8; ++k) ms[8 * i + k] = g_shadow[REG_MS0_P3_15_8 + 8 * i + k];
+            defined |= (uint8_t)(1u << i);
+            continue;
+        }
+        encode_msx(&mp.out[i], &ms[8 * i]);
+        clk[i] = CLKx_SRC_MS | CLKx_DRIVE_8MA;
+        if (mp.out[i].ms.b == 0 && (mp.out[i].ms.a & 1u) == 0) clk[i] |= CLKx_INT;
+        if (mp.src[i]) clk[i] |= CLKx_SRC_PLLB;
+        else if (i > 0) shared |= (uint8_t)(1u << i);
+        oe &= (uint8_t)~(1u << i);
+        defined |= (uint8_t)(1u << i);
+    }
+
+    bool a_changed = false, b_changed = false;
+    if (mp.pll_used[0] && !reg_write(REG_MSNA_P3_15_8, &plls[0], 8, &a_changed)) return false;
+    if (mp.pll_used[1] && !reg_write(REG_MSNB_P3_15_8, &plls[8], 8, &b_changed)) return false;
+    /* MS0..MS2 burstem przez określone wyjścia; nieznany MS wyłączonego wyjścia dzieli burst */
+    for (uint8_t i = 0; i < SI5351_NUM_OUTPUTS; ++i) {
+        if (!(defined & (1u << i))) continue;
+        uint8_t j = i;
+        while (j + 1 < SI5351_NUM_OUTPUTS && (defined & (1u << (j + 1)))) ++j;
+        if (!reg_write(REG_MS0_P3_15_8 + 8 * i, &ms[8 * i], 8 * (j - i + 1), NULL)) return false;
+        i = j;
+    }
+    if (!reg_write(REG_CLK0_CTRL, clk, sizeof(clk), NULL)) return false;
+    if (!reg_write(REG_OE_CTRL, &oe, 1, NULL)) return false;
+
+    /* jeden reset dla wszystkich zmienionych PLL */
+    uint8_t reset = (a_changed ? PLL_RESET_A : 0) | (b_changed ? PLL_RESET_B : 0);
+    if (reset && !wr8(REG_PLL_RESET, reset)) return false;
+
+    /* Stan CLK0 dla si5351_clk0_set() / trybu stałego VCO */
+    g_plla_valid = mp.pll_used[0];
+    if (g_plla_valid) g_plla = mp.pll[0];
+    g_plla_shared = shared;
+    g_clk0_hz = mp.enabled[0] ? fout_hz[0] : 0;
+
+    if (reset) g_tune_stats.pll_resets++;
+    return si5351_finish(reset);
+}
+
+void si5351_cache_get_stats(si5351_cache_stats_t *stats) {
+    *stats = g_cache_stats;
+}
+
+void si5351_cache_flush(void) {
+    for (uint32_t i = 0; i < SI5351_CACHE_SIZE; ++i) g_cache[i].fout_hz = 0;
+    g_cache_stats.hits = 0;
+    g_cache_stats.misses = 0;
+}
+
+void si5351_bus_get_stats(si5351_bus_stats_t *stats) {
+    *stats = g_bus_stats;
+}
+
+void si5351_bus_reset_stats(void) {
+    g_bus_stats.transactions = 0;
+    g_bus_stats.bytes = 0;
+    g_bus_stats.errors = 0;
+}
+
+void si5351_shadow_invalidate(void) {
+    for (uint32_t i = 0; i < sizeof(g_shadow_valid); ++i) g_shadow_valid[i] = 0;
+    g_plla_valid = false;
+}
+
 uint32_t si5351_clk0_get_hz(void) {
     return g_clk0_hz;
 }
@@ -239,6 +899,9 @@ uint32_t si5351_clk0_get_hz(void) {
 /* Prosta inicjalizacja: wyłącz wszystko na starcie */
 bool si5351_init(void) {
     /* Domyślnie wyłącz wyjścia (OE high) i potem włączamy przy ustawianiu częstotliwości */
-    if (!wr8(REG_OE_CTRL, 0xFF)) return false; /* wszystkie disabled */
-    return true;
+    const uint8_t oe = 0xFF; /* wszystkie disabled */
+    si5351_shadow_invalidate();
+    g_plla_shared = 0;
+    if (!reg_write(REG_OE_CTRL, &oe, 1, NULL)) return false;
+    return si5351_wait();
 }
\ No newline at end of file
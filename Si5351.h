@@ -1,8 +1,135 @@
 #ifndef Si5351_H
 #define Si5351_H
 
-void si5351_init(void);
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Gotowy obraz rejestrów dla CLK0: MSNA (26..33), MS0 (42..49), CLK0_CTRL (16) */
+typedef struct {
+    uint8_t msna[8];
+    uint8_t ms0[8];
+    uint8_t clk0;
+} si5351_clk0_regs_t;
+
+/* Dzielnik ułamkowy a + b/c, c <= 1048575 */
+typedef struct {
+    uint32_t a, b, c;
+} si5351_frac_t;
+
+/* Plan częstotliwości: fout = XTAL * pll / (ms * 2^rdiv) */
+typedef struct {
+    si5351_frac_t pll;      /* fvco / fxtal */
+    si5351_frac_t ms;       /* fvco / (fout * R); przy divby4 zawsze 4 */
+    uint8_t rdiv;           /* 0..7: 0=>/1, ..., 7=>/128 */
+    bool divby4;
+    uint64_t achieved_mhz;  /* osiągnięta częstotliwość w mHz */
+    int32_t error_mhz;      /* achieved - żądana, w mHz */
+} si5351_plan_t;
+
+/* Plan trzech wyjść na dwóch PLL */
+#define SI5351_NUM_OUTPUTS 3
+
+typedef struct {
+    si5351_frac_t pll[2];               /* PLLA, PLLB */
+    bool pll_used[2];
+    si5351_plan_t out[SI5351_NUM_OUTPUTS];
+    uint8_t src[SI5351_NUM_OUTPUTS];    /* 0 => PLLA, 1 => PLLB */
+    bool enabled[SI5351_NUM_OUTPUTS];
+} si5351_multi_plan_t;
+
+/* Liczniki pamięci podręcznej planów */
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+} si5351_cache_stats_t;
+
+/* Liczniki ruchu I2C: transakcje i bajty (z bajtem numeru rejestru, bez adresu układu) */
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t errors;        /* transakcje przerwane (NACK) */
+} si5351_bus_stats_t;
+
+/* Ścieżka ostatniego strojenia */
+typedef enum {
+    SI5351_TUNE_NONE = 0,
+    SI5351_TUNE_FULL,       /* pełny plan PLLA + MS0; reset PLL gdy MSNA się zmieniło */
+    SI5351_TUNE_MS_ONLY     /* przypięte VCO: tylko MS0, bez resetu PLL */
+} si5351_tune_path_t;
+
+typedef struct {
+    uint32_t full;
+    uint32_t ms_only;
+    uint32_t pll_resets;
+} si5351_tune_stats_t;
+
+bool si5351_init(void);
 bool si5351_clk0_set(uint32_t fout_hz);
+
+/*
+ * Zapis przez asynchroniczny transport I2C0 (i2c_async): si5351_clk0_set_async()
+ * tylko kolejkuje bursty i wraca, *pll_reset (opcjonalnie) mówi, czy PLL
+ * zostało zresetowane. si5351_busy() mówi, czy coś jest jeszcze w drodze,
+ * a si5351_wait() czeka i zwraca false, jeśli od poprzedniego si5351_wait()
+ * któraś transakcja się nie powiodła. si5351_finish() to si5351_wait()
+ * z odczekaniem na zatrzaśnięcie PLL po resecie – razem z set_async daje
+ * si5351_clk0_set().
+ */
+bool si5351_clk0_set_async(uint32_t fout_hz, bool *pll_reset);
+bool si5351_busy(void);
+bool si5351_wait(void);
+bool si5351_finish(bool pll_reset);
 uint32_t si5351_clk0_get_hz(void);
 
-#endif
\ No newline at end of file
+/* Planowanie bez dostępu do I2C: najlepsze a+b/c dla PLLA i MS0 */
+bool si5351_plan(uint32_t fout_hz, si5351_plan_t *plan);
+
+/* Plan dla zadanego PLLA: tylko MS0 i R; false gdy fout jest poza zasięgiem tego VCO */
+bool si5351_plan_from_vco(const si5351_frac_t *pll, uint32_t fout_hz, si5351_plan_t *plan);
+
+/*
+ * Stałe VCO: po przypięciu si5351_clk0_set() przestraja tylko MS0, a pełny
+ * plan z resetem PLL robi jedynie gdy fout wyjdzie poza zasięg bieżącego VCO
+ * (nowe VCO zostaje wtedy przypięte).
+ */
+void si5351_vco_pin(void);
+void si5351_vco_unpin(void);
+bool si5351_vco_is_pinned(void);
+si5351_tune_path_t si5351_last_tune_path(void);
+void si5351_tune_get_stats(si5351_tune_stats_t *stats);
+
+/*
+ * CLK0..CLK2 naraz (0 Hz => wyjście wyłączone). Wyjścia dzielą PLLA/PLLB,
+ * jeśli wspólne VCO daje całkowite MS; w przeciwnym razie trzecie wyjście
+ * dostaje ułamkowy MS. Zapis jednym ciągiem burstów z jednym resetem PLL.
+ * Dopóki CLK1/CLK2 pracują z PLLA, si5351_clk0_set() przestraja tylko MS0
+ * (false, gdy fout jest poza zasięgiem tego VCO), a si5351_clk0_apply()
+ * odrzuca obrazy z innym MSNA; zwalnia je si5351_init() albo kolejne
+ * si5351_multi_set() bez wspólnego PLLA.
+ */
+bool si5351_multi_plan(const uint32_t fout_hz[SI5351_NUM_OUTPUTS], si5351_multi_plan_t *plan);
+bool si5351_multi_set(const uint32_t fout_hz[SI5351_NUM_OUTPUTS]);
+
+/* Liczy obraz rejestrów bez dostępu do I2C i z pominięciem pamięci podręcznej */
+bool si5351_clk0_calc(uint32_t fout_hz, si5351_clk0_regs_t *regs);
+
+/* Obraz rejestrów z gotowego planu */
+void si5351_clk0_build(const si5351_plan_t *plan, si5351_clk0_regs_t *regs);
+
+/*
+ * Zapis gotowego obrazu (np. z tablicy przemiatania) przez kopię rejestrów.
+ * Tylko kolejkuje bursty i nie czeka na zatrzaśnięcie PLL – można wołać
+ * z przerwania; *pll_reset (opcjonalnie) mówi, czy PLL zostało zresetowane.
+ */
+bool si5351_clk0_apply(const si5351_clk0_regs_t *regs, uint32_t fout_hz, bool *pll_reset);
+
+void si5351_cache_get_stats(si5351_cache_stats_t *stats);
+void si5351_cache_flush(void);
+
+void si5351_bus_get_stats(si5351_bus_stats_t *stats);
+void si5351_bus_reset_stats(void);
+
+/* Zapomina kopię rejestrów – następny zapis wyśle pełne bloki (np. po resecie układu) */
+void si5351_shadow_invalidate(void);
+
+#endif
@@ -0,0 +1,126 @@
+#include <stddef.h>
+
+#include "button_gesture.h"
+
+enum {
+    ST_IDLE = 0,
+    ST_DOWN,        // first press, long press not reached yet
+    ST_UP,          // released after one click, second press may follow
+    ST_DOWN2,       // second press within double_us
+    ST_HELD         // long press sent, repeating while down
+};
+
+static void emit(button_gesture_t *g, uint8_t type, uint8_t repeat, uint64_t t_us) {
+    unsigned head = atomic_load_explicit(&g->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&g->tail, memory_order_acquire);
+    if (head - tail >= BUTTON_GESTURE_QUEUE_LEN) {
+        // producer-only counter: a load and a store, no read-modify-write (none on Cortex-M0+)
+        atomic_store_explicit(&g->dropped, atomic_load_explicit(&g->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return;
+    }
+    g->ring[head % BUTTON_GESTURE_QUEUE_LEN] = (button_gesture_event_t){.type = type, .repeat = repeat, .t_us = t_us};
+    atomic_store_explicit(&g->head, head + 1, memory_order_release);
+}
+
+void button_gesture_init(button_gesture_t *g, const button_gesture_config_t *cfg) {
+    g->cfg = *cfg;
+    g->state = ST_IDLE;
+    g->repeat = 0;
+    g->t_down = g->t_up = 0;
+    g->deadline = 0;
+    atomic_init(&g->head, 0);
+    atomic_init(&g->tail, 0);
+    atomic_init(&g->dropped, 0);
+}
+
+void button_gesture_edge(button_gesture_t *g, bool pressed, uint64_t t_us) {
+    // timeouts that were due before this edge happened first
+    if (g->deadline && g->deadline <= t_us)
+        button_gesture_tick(g, g->deadline);
+
+    if (pressed) {
+        g->t_down = t_us;
+        if (g->state == ST_UP) {
+            g->state = ST_DOWN2;
+        } else {
+            g->state = ST_DOWN;
+        }
+        g->deadline = t_us + g->cfg.long_us;
+        return;
+    }
+
+    g->t_up = t_us;
+    switch (g->state) {
+    case ST_DOWN:
+        if (g->cfg.double_us) {
+            if (!g->cfg.click_waits)
+                emit(g, BUTTON_CLICK, 0, t_us);
+            g->state = ST_UP;
+            g->deadline = t_us + g->cfg.double_us;
+        } else {
+            emit(g, BUTTON_CLICK, 0, t_us);
+            g->state = ST_IDLE;
+            g->deadline = 0;
+        }
+        break;
+    case ST_DOWN2:
+        emit(g, BUTTON_DOUBLE_CLICK, 0, t_us);
+        g->state = ST_IDLE;
+        g->deadline = 0;
+        break;
+    default:
+        // end of a long press, or a release without a seen press
+        g->state = ST_IDLE;
+        g->deadline = 0;
+        break;
+    }
+}
+
+void button_gesture_tick(button_gesture_t *g, uint64_t now_us) {
+    while (g->deadline && g->deadline <= now_us) {
+        uint64_t due = g->deadline;
+        switch (g->state) {
+        case ST_DOWN:
+        case ST_DOWN2:
+            // a held second press is a long press too; its first click stays a click
+            if (g->state == ST_DOWN2 && g->cfg.click_waits)
+                emit(g, BUTTON_CLICK, 0, g->t_up);
+            emit(g, BUTTON_LONG_PRESS, 0, due);
+            g->state = ST_HELD;
+            g->repeat = 0;
+            g->deadline = g->cfg.repeat_us ? due + g->cfg.repeat_us : 0;
+            break;
+        case ST_HELD:
+            if (g->repeat < UINT8_MAX)
+                ++g->repeat;
+            emit(g, BUTTON_HOLD_REPEAT, g->repeat, due);
+            g->deadline = due + g->cfg.repeat_us;
+            break;
+        case ST_UP:
+            // no second press: the first one was a single click
+            if (g->cfg.click_waits)
+                emit(g, BUTTON_CLICK, 0, g->t_up);
+            g->state = ST_IDLE;
+            g->deadline = 0;
+            break;
+        default:
+            g->deadline = 0;
+            break;
+        }
+    }
+}
+
+uint64_t button_gesture_deadline(const button_gesture_t *g) {
+    return g->deadline;
+}
+
+bool button_gesture_pop(button_gesture_t *g, button_gesture_event_t *ev) {
+    unsigned tail = atomic_load_explicit(&g->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&g->head, memory_order_acquire);
+    if (tail == head)
+        return false;
+    *ev = g->ring[tail % BUTTON_GESTURE_QUEUE_LEN];
+    atomic_store_explicit(&g->tail, tail + 1, memory_order_release);
+    return true;
+}
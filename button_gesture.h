@@ -0,0 +1,64 @@
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+typedef enum {
+    BUTTON_CLICK = 1,       // released before long_us
+    BUTTON_DOUBLE_CLICK,    // second click within double_us; replaces the second CLICK
+    BUTTON_LONG_PRESS,      // held for long_us, sent while still down
+    BUTTON_HOLD_REPEAT      // every repeat_us after LONG_PRESS while still down
+} button_gesture_type_t;
+
+typedef struct {
+    uint8_t type;           // button_gesture_type_t
+    uint8_t repeat;         // HOLD_REPEAT: 1, 2, ...
+    uint64_t t_us;          // edge or timeout that produced the event
+} button_gesture_event_t;
+
+#ifndef BUTTON_GESTURE_QUEUE_LEN
+#define BUTTON_GESTURE_QUEUE_LEN 8  // power of two
+#endif
+
+typedef struct {
+    uint32_t long_us;
+    uint32_t double_us;     // 0 disables DOUBLE_CLICK
+    uint32_t repeat_us;     // 0 disables HOLD_REPEAT
+    bool click_waits;       // hold CLICK back until double_us has passed (no CLICK before a DOUBLE_CLICK)
+} button_gesture_config_t;
+
+// Recognizer fed with debounced edges (button_gesture_edge) and timeouts
+// (button_gesture_tick at button_gesture_deadline). Both run in the producer
+// context, e.g. the button and alarm IRQs of one core; the events go through a
+// lock-free single-producer/single-consumer queue to button_gesture_pop.
+typedef struct {
+    button_gesture_config_t cfg;
+    uint8_t state;
+    uint8_t repeat;
+    uint64_t t_down;        // last press
+    uint64_t t_up;          // last release
+    uint64_t deadline;      // 0: nothing pending
+
+    button_gesture_event_t ring[BUTTON_GESTURE_QUEUE_LEN];
+    atomic_uint head;       // written by the producer
+    atomic_uint tail;       // written by the consumer
+    atomic_uint dropped;    // events lost to a full queue
+} button_gesture_t;
+
+void button_gesture_init(button_gesture_t *g, const button_gesture_config_t *cfg);
+
+// Debounced level change at t_us
+void button_gesture_edge(button_gesture_t *g, bool pressed, uint64_t t_us);
+
+// Timeouts due at now_us
+void button_gesture_tick(button_gesture_t *g, uint64_t now_us);
+
+// When button_gesture_tick has to run next, 0 if nothing is pending
+uint64_t button_gesture_deadline(const button_gesture_t *g);
+
+// Consumer side: next event, false if the queue is empty
+bool button_gesture_pop(button_gesture_t *g, button_gesture_event_t *ev);
+
+#endif
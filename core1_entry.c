@@ -3,24 +3,33 @@
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
 #include "pico/binary_info.h"
-#include "pico/util/queue.h"
 #include "pico/sem.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
 #include <string.h>
 #include <stdlib.h>
 
 #include "ssd1306_setup.h"
-#include "bubblesstandard_font.h"
+#include "ui_screen.h"
 #include "quadrature_encoder.pio.h"
 #include "button.pio.h"
 #include "AT24C256.h"
+#include "encoder_input.h"
+#include "button_gesture.h"
+#include "core_msg.h"
 
 
-#define READY_FLAG 234
-#define TARGET_T   101
-#define CLICK      102
-#define LONG_CLICK 103
 #define NUM_DIGITS 9
 #define ENCODER_STEP_DIVISOR 4
+// a pause longer than this between detents starts the next spin slow
+#define ENCODER_ACCEL_IDLE_US 250000
+#define FREQ_MIN 8000u
+#define FREQ_MAX 160000000u
+#define BUTTON_LONG_US   600000
+#define BUTTON_DOUBLE_US 300000
+#define BUTTON_REPEAT_US 200000
+// quadrature steps per second the SM must resolve; a hand spin stays well below 2000
+#define ENCODER_MAX_STEP_RATE 20000
 #define DEBOUNCE_US 10000
 #define BUTTON_DEBOUNCE_US 20000
 #define FONT_SCALE 2
@@ -34,153 +43,294 @@
 #define ENCODER_B_PIN 27
 #define BUTTON_PIN    2
 
+// 0 - sleep until input; otherwise resend the whole screen after this much idle time
+#define UI_IDLE_TIMEOUT_MS 0
+// retry period while the previous frame is still on I2C1 (its IRQ runs on core0)
+// or the EEPROM is still writing the last committed value
+#define UI_FLUSH_RETRY_MS  1
+
 uint target = 9;
 
 uint8_t read_data[32] = {0};
 uint16_t mem_addr = 0x0100; // Arbitrary address
 
-queue_t core0_to_core1_queue;
-queue_t core1_to_core0_queue;
+core_msg_ring_t core0_to_core1_ring;
+core_msg_ring_t core1_to_core0_ring;
 
 bool oled_timer_callback(repeating_timer_t *rt);
 repeating_timer_t oled_timer;
 
-typedef struct
-{
-    uint8_t msgId; // 234 - READY_FLAG
-    uint8_t objId;
-    int32_t command;
-    void *dataPtr;
-    uint16_t dataLen;
-} queue_entry_t;
+// set by the input interrupts, cleared by the UI loop before it samples the inputs
+static volatile bool ui_event = false;
+
+static void encoder_gpio_irq(uint gpio, uint32_t events) {
+    ui_event = true;
+    __sev();
+}
+
+// Button edges and gesture timeouts are both handled in core1 IRQs of equal
+// priority, so the recognizer never runs twice at once and is the single
+// producer of its event queue.
+static button_gesture_t gestures;
+static alarm_pool_t *gesture_pool;
+static alarm_id_t gesture_alarm;
+
+static int64_t gesture_alarm_cb(alarm_id_t id, void *user) {
+    uint64_t now = time_us_64();
+    button_gesture_tick(&gestures, now);
+    ui_event = true;
+    __sev();
+
+    uint64_t next = button_gesture_deadline(&gestures);
+    if (!next) {
+        gesture_alarm = 0;
+        return 0;
+    }
+    // rescheduled relative to the return of the callback
+    return next > now ? (int64_t) (next - now) : 1;
+}
+
+static void gesture_schedule(void) {
+    if (gesture_alarm > 0)
+        alarm_pool_cancel_alarm(gesture_pool, gesture_alarm);
+    gesture_alarm = 0;
+
+    uint64_t next = button_gesture_deadline(&gestures);
+    if (next)
+        gesture_alarm = alarm_pool_add_alarm_at(gesture_pool, from_us_since_boot(next), gesture_alarm_cb, NULL, true);
+}
+
+static void button_fifo_irq(void) {
+    // every entry is a debounced level: all ones released, zero pressed
+    while (!pio_sm_is_rx_fifo_empty(pio1, button_sm))
+        button_gesture_edge(&gestures, pio_sm_get(pio1, button_sm) == 0, time_us_64());
+    gesture_schedule();
+    ui_event = true;
+    __sev();
+}
+
+// runs on core1, so the input interrupts are taken (and wake WFE) there
+static void ui_event_setup(void) {
+    // the encoder SM pushes its count on every loop, so its FIFO is never empty;
+    // the pin edges it samples are the change events
+    gpio_set_irq_enabled_with_callback(ENCODER_A_PIN, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, encoder_gpio_irq);
+    gpio_set_irq_enabled(ENCODER_A_PIN + 1, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+
+    // the button SM pushes only debounced changes; the alarm IRQ of the pool is taken on this core too
+    const button_gesture_config_t cfg = {
+        .long_us = BUTTON_LONG_US,
+        .double_us = BUTTON_DOUBLE_US,
+        .repeat_us = BUTTON_REPEAT_US,
+        .click_waits = false,   // a click acts on release; a quick second one becomes DOUBLE_CLICK
+    };
+    button_gesture_init(&gestures, &cfg);
+    gesture_pool = alarm_pool_create_with_unused_hardware_alarm(2);
+    irq_set_exclusive_handler(PIO1_IRQ_0, button_fifo_irq);
+    pio_set_irq0_source_enabled(pio1, (enum pio_interrupt_source) (pis_sm0_rx_fifo_not_empty + button_sm), true);
+    irq_set_enabled(PIO1_IRQ_0, true);
+}
+
+static absolute_time_t ui_idle_deadline(void) {
+    return UI_IDLE_TIMEOUT_MS ? make_timeout_time_ms(UI_IDLE_TIMEOUT_MS) : at_the_end_of_time;
+}
+
+// sleep until an input event, a core0 message (pushes SEV) or the deadline
+static bool ui_wait(bool flush_pending, absolute_time_t idle_until) {
+    absolute_time_t until = flush_pending ? make_timeout_time_ms(UI_FLUSH_RETRY_MS) : idle_until;
+    if (ui_event)
+        return false;
+    if (is_at_the_end_of_time(until)) {
+        __wfe();
+        return false;
+    }
+    return best_effort_wfe_or_timeout(until) && !flush_pending;
+}
+
+// detents per second -> steps of the selected digit per detent
+static const encoder_curve_point_t encoder_curve[] = {
+    {0, 1}, {6, 2}, {10, 5}, {15, 10}, {20, 25}, {30, 50},
+};
+
+static const uint32_t digit_place[NUM_DIGITS] = {
+    100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1,
+};
+
+static void freq_to_digits(uint32_t freq, int *digits) {
+    for (int i = NUM_DIGITS - 1; i >= 0; --i) {
+        digits[i] = freq % 10;
+        freq /= 10;
+    }
+}
+
+// value for the EEPROM, written by ui_store_poll() after core0 already has it
+static char store_buffer[NUM_DIGITS + 1];
+static bool store_pending = false;
+
+// starts the pending page write once the previous write cycle is over;
+// true while the EEPROM still needs polling
+static bool ui_store_poll(void) {
+    if (at24c256_write_busy())
+        return true;
+    if (!store_pending)
+        return false;
+    // a failed start stays pending and is retried on the next call
+    if (at24c256_write_start(mem_addr, (const uint8_t *)store_buffer, sizeof(store_buffer)))
+        store_pending = false;
+    return true;
+}
+
+// hand the value to core0, then queue it for the EEPROM; t_input_us: when the input was detected
+static void ui_commit(uint32_t freq, const int *digits, uint64_t t_input_us) {
+    uint32_t new_freq = freq;
+    if (new_freq < FREQ_MIN) new_freq = FREQ_MIN;
+    if (new_freq > FREQ_MAX) new_freq = FREQ_MAX;
+    core_msg_t msg = {.objId = CORE_OBJ_FREQ, .freq.hz = new_freq, .t_input_us = t_input_us};
+    msg.t_queued_us = time_us_64();
+    // the value travels in the message; a full ring only happens if core0 stalls
+    while (!core_msg_push(&core1_to_core0_ring, &msg))
+        tight_loop_contents();
+    __sev();
+    printf("Sent frequency to core0: %lu Hz\n", new_freq);
+
+    // the 5 ms write cycle runs behind the UI; a newer commit replaces a value not yet started
+    for (int i = 0; i < NUM_DIGITS; ++i)
+        store_buffer[i] = digits[i] + '0';
+    store_buffer[NUM_DIGITS] = '\0';
+    store_pending = true;
+    ui_store_poll();
+}
+
+// value stored by ui_commit, false if the EEPROM holds none
+static bool ui_recall(uint32_t *freq) {
+    // a commit still on its way to the EEPROM is the newest value
+    while (ui_store_poll())
+        tight_loop_contents();
+
+    char read_buffer[NUM_DIGITS + 1] = {0};
+    if (!at24c256_read(mem_addr, (uint8_t *)read_buffer, NUM_DIGITS))
+        return false;
+    uint32_t f = 0;
+    for (int i = 0; i < NUM_DIGITS; ++i) {
+        if (read_buffer[i] < '0' || read_buffer[i] > '9')
+            return false;
+        f = f * 10 + (read_buffer[i] - '0');
+    }
+    *freq = f > FREQ_MAX ? FREQ_MAX : f;
+    return true;
+}
 
 void encoder_button_setup() {
     // --- Encoder ---
     PIO enc_pio = pio0;
     uint enc_offset = pio_add_program(enc_pio, &quadrature_encoder_program);
-    quadrature_encoder_program_init(enc_pio, ENCODER_A_PIN, 10); // max_step_rate=0 for max speed
+    quadrature_encoder_program_init(enc_pio, ENCODER_A_PIN, ENCODER_MAX_STEP_RATE); // SM clocked at 10 * 20000 = 200 kHz, one loop per 50 us
+    quadrature_encoder_start_dma(); // reading the count is a plain load from now on
 
     // --- Button ---
     PIO btn_pio = pio1;
     uint btn_offset = pio_add_program(btn_pio, &button_program);
     button_init(btn_pio, btn_offset, BUTTON_PIN);
+
+    ui_event_setup();
 }
 
 void core1_entry() {
    
     encoder_button_setup();
 
-    queue_entry_t response;
-    queue_remove_blocking(&core0_to_core1_queue, &response);
-    if (response.msgId != READY_FLAG) {
-        printf("Core1: Unexpected initial message ID %d\n", response.msgId);
+    core_msg_t msg;
+    while (!core_msg_pop(&core0_to_core1_ring, &msg))
+        __wfe();
+    if (msg.objId != CORE_OBJ_STATUS || msg.msgId != CORE_STATUS_READY) {
+        printf("Core1: Unexpected initial message %d/%d\n", msg.objId, msg.msgId);
     }
 
-    queue_entry_t msg;
     int digits[NUM_DIGITS] = {0, 0, 0, 0, 0, 0, 0, 0, 0}; // 9 digits int tabela[]={0,0,0,0,0,0,0,0,0};
     int selected_digit = 0;       // Which digit is selected (0-8)
     bool editing = false;         // Are we editing the digit value?
-    int old_encoder = 0;
+    uint32_t freq = 0;            // value shown, digits[] is its decimal form
+    int old_encoder = quadrature_encoder_get_count();
     int new_encoder, delta;
-    uint32_t last_button_state = 0;
-
-    // Helper buffer for display
-    char digits_str[NUM_DIGITS + 1];
+    encoder_input_t enc;
+    encoder_input_init(&enc, ENCODER_STEP_DIVISOR, encoder_curve, count_of(encoder_curve), ENCODER_ACCEL_IDLE_US);
 
     // Initial display
-    for (int i = 0; i < NUM_DIGITS; ++i)
-    digits_str[i] = digits[i] + '0';
-    digits_str[NUM_DIGITS] = '\0';
-    ssd1306_clear(&disp);
-    ssd1306_draw_string_with_font(&disp, 5, 35, 2, bubblesstandard_font, digits_str);
+    ui_draw_frequency(&disp, digits, NUM_DIGITS, selected_digit, editing);
     ssd1306_show(&disp);
 
-    int idx =0;
+    bool redraw = true;           // UI state changed since the last frame
+    bool flush = false;           // frame drawn but not yet handed to I2C1
+    absolute_time_t idle_until = ui_idle_deadline();
+
     while (1){
+        ui_event = false;
+
         new_encoder = quadrature_encoder_get_count();
         delta = new_encoder - old_encoder;
         old_encoder = new_encoder;
 
-            if(delta !=0){
-            int steps = delta / ENCODER_STEP_DIVISOR; 
-                if (editing) {
-                // Zapętlanie wartości cyfry z ograniczeniami zakresu
-                    if (selected_digit == 0) {
-                    // Pierwsza pozycja: zakres 0-1
-                    digits[selected_digit] = (digits[selected_digit] + steps) % 2;
-                        if (digits[selected_digit] < 0) digits[selected_digit] += 2;
-                    }else {
-                    // Pozostałe pozycje: zakres 0-9
-                    digits[selected_digit] = (digits[selected_digit] + steps) % 10;
-                        if (digits[selected_digit] < 0) digits[selected_digit] += 10;
-                    }
-            }else{
-                selected_digit += steps;
+        // partial detents stay in enc for the next read
+        int32_t steps;
+        int32_t detents = encoder_input_update(&enc, delta, time_us_64(), &steps);
+        if (detents != 0) {
+            redraw = true;
+            if (editing) {
+                // accelerated, carried into the higher digits, clamped to the range
+                freq = encoder_input_tune(freq, steps, digit_place[selected_digit], FREQ_MAX);
+                freq_to_digits(freq, digits);
+            } else {
+                // the cursor moves one digit per detent
+                selected_digit += detents;
                 if (selected_digit < 0) selected_digit = 0;
                 if (selected_digit > NUM_DIGITS - 1) selected_digit = NUM_DIGITS - 1;
             }
         }
-        // Handle button
-        uint32_t button_state = 0;
-        bool result = button_get_state(&button_state);
-        if (result) {
-            if (!last_button_state && button_state) {
+        // Button gestures, recognized in the IRQs
+        button_gesture_event_t ev;
+        while (button_gesture_pop(&gestures, &ev)) {
+            switch (ev.type) {
+            case BUTTON_CLICK:
                 editing = !editing;
-                if (!editing) { // Save to EEPROM when exiting edit mode
-                    for (int i = 0; i < NUM_DIGITS; ++i){
-                        digits_str[i] = digits[i] + '0';
-                    }
-                        digits_str[NUM_DIGITS] = '\0';
-
-                        char write_buffer[16];
-                        strncpy(write_buffer, digits_str, sizeof(write_buffer) - 1);
-                        write_buffer[sizeof(write_buffer) - 1] = '\0';
-                        at24c256_write(mem_addr, (uint8_t *)write_buffer, strlen(write_buffer) + 1);
-
-                        uint32_t new_freq = strtoul(digits_str, NULL, 10);
-                        if (new_freq < 8000u) new_freq = 8000u;
-                        if (new_freq > 160000000u) new_freq = 160000000u;
-                        queue_entry_t msg = {
-                        .msgId = 0,
-                        .objId = TARGET_T,
-                        .command = new_freq,
-                        .dataPtr = &new_freq,
-                        .dataLen = sizeof(new_freq)
-                         };
-                queue_add_blocking(&core1_to_core0_queue, &msg);
-                printf("Sent frequency to core0: %lu Hz\n", new_freq);
+                if (!editing) // Save to EEPROM and send when exiting edit mode
+                    ui_commit(freq, digits, ev.t_us);
+                redraw = true;
+                break;
+            case BUTTON_LONG_PRESS:
+                // recall the stored value into the editor
+                if (ui_recall(&freq)) {
+                    freq_to_digits(freq, digits);
+                    editing = true;
+                    redraw = true;
                 }
+                break;
+            default:
+                // DOUBLE_CLICK and HOLD_REPEAT are free for further bindings
+                break;
             }
-            last_button_state = button_state;
         }
-        
-        // Prepare display string
-        for (int i = 0; i < NUM_DIGITS; ++i)
-            digits_str[i] = digits[i] + '0';
-            digits_str[NUM_DIGITS] = '\0';
-
-        //OLED update
-        ssd1306_clear(&disp);
-        ssd1306_draw_string_with_font(&disp, 5, 35, 2, bubblesstandard_font, digits_str);
-
-        // Draw underline or box for selected digit
-        int char_width = 7 * 2; // font width * scale (adjust if needed)
-        int x = 5 + selected_digit * char_width;
-        int y = 55;
-        if (editing){
-            // Draw a box around the digit
-            ssd1306_draw_empty_square(&disp, x - 2, y - 20, char_width, 20);
-        }else{
-            // Draw underline
-            ssd1306_draw_line(&disp, x, y, x + char_width - 5, y);
+
+        while (core_msg_pop(&core0_to_core1_ring, &msg)) {
+            // replies from core0 (CORE_OBJ_STATUS) are not shown yet
+        }
+
+        if (redraw) {
+            ui_draw_frequency(&disp, digits, NUM_DIGITS, selected_digit, editing);
+            redraw = false;
+            flush = true;
         }
 
-        ssd1306_show(&disp);
-        
-        if(queue_try_remove(&core0_to_core1_queue, &msg)) {
-            // handle messages if needed
-        } 
-        sleep_ms(50); // Add a small delay to avoid flicker 
+        // a frame still on the bus is not waited for; this one is retried shortly
+        if (flush && ssd1306_show_async(&disp)) {
+            flush = false;
+            idle_until = ui_idle_deadline();
+        }
+
+        bool storing = ui_store_poll();
 
+        if (ui_wait(flush || storing, idle_until)) {
+            // idle: resend everything in case the display lost its contents
+            ssd1306_invalidate(&disp);
+            flush = true;
+        }
     }
 }
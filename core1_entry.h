@@ -1,22 +1,13 @@
 #ifndef CORE1_ENTRY_H
 #define CORE1_ENTRY_H
 
-#include "pico/util/queue.h"
+#include "core_msg.h"
 
-#define READY_FLAG 234
-#define TARGET_T 101
 #define NUM_DIGITS 9
 
-typedef struct {
-    uint8_t msgId;
-    uint8_t objId;
-    int32_t command;
-    void *dataPtr;
-    uint16_t dataLen;
-} queue_entry_t;
-
-extern queue_t core0_to_core1_queue;
-extern queue_t core1_to_core0_queue;
+// one ring per direction; core1_to_core0 coalesces CORE_OBJ_FREQ
+extern core_msg_ring_t core0_to_core1_ring;
+extern core_msg_ring_t core1_to_core0_ring;
 extern char digits_str;
 extern uint16_t mem_addr;
 
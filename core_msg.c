@@ -0,0 +1,62 @@
+#include "core_msg.h"
+
+void core_msg_ring_init(core_msg_ring_t *r, uint32_t coalesce) {
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->dropped, 0);
+    r->coalesce = coalesce;
+    r->coalesced = 0;
+}
+
+bool core_msg_push(core_msg_ring_t *r, const core_msg_t *m) {
+    unsigned head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail >= CORE_MSG_RING_LEN) {
+        // producer-only counter: a load and a store, no read-modify-write
+        atomic_store_explicit(&r->dropped, atomic_load_explicit(&r->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+    r->ring[head % CORE_MSG_RING_LEN] = *m;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+static bool superseded(const core_msg_ring_t *r, const core_msg_t *m, const core_msg_t *next) {
+    return (r->coalesce >> m->objId & 1) && next->objId == m->objId && next->msgId == m->msgId;
+}
+
+bool core_msg_pop(core_msg_ring_t *r, core_msg_t *m) {
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    // the producer never touches published slots, so the consumer may look ahead;
+    // only a direct successor supersedes, which keeps the order against other objects
+    while (head - tail > 1 &&
+           superseded(r, &r->ring[tail % CORE_MSG_RING_LEN], &r->ring[(tail + 1) % CORE_MSG_RING_LEN])) {
+        ++tail;
+        ++r->coalesced;
+    }
+    *m = r->ring[tail % CORE_MSG_RING_LEN];
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t core_msg_dispatch(core_msg_ring_t *r, const core_msg_handler_t handlers[CORE_OBJ_COUNT]) {
+    uint32_t n = 0;
+    core_msg_t m;
+    while (core_msg_pop(r, &m)) {
+        ++n;
+        if (m.objId < CORE_OBJ_COUNT && handlers[m.objId])
+            handlers[m.objId](&m);
+    }
+    return n;
+}
+
+uint32_t core_msg_pending(core_msg_ring_t *r) {
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return head - tail;
+}
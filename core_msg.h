@@ -0,0 +1,92 @@
+#ifndef CORE_MSG_H
+#define CORE_MSG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "sweep.h"
+
+// What a message is about; selects the payload
+typedef enum {
+    CORE_OBJ_FREQ = 1,      // set CLK0
+    CORE_OBJ_PRESET,        // store or recall a frequency slot
+    CORE_OBJ_SWEEP,         // start or stop a sweep
+    CORE_OBJ_STATUS,        // replies and notifications
+    CORE_OBJ_COUNT
+} core_msg_obj_t;
+
+// msgId of the objects that have more than one command
+enum {
+    CORE_PRESET_STORE = 0,
+    CORE_PRESET_RECALL
+};
+enum {
+    CORE_SWEEP_START = 0,
+    CORE_SWEEP_STOP
+};
+enum {
+    CORE_STATUS_READY = 0,  // core0 is set up, core1 may start
+    CORE_STATUS_FREQ,       // value: frequency CLK0 was set to
+    CORE_STATUS_ERROR       // value: objId of the message that failed
+};
+
+// A message is copied into the ring whole; nothing points back at the sender.
+typedef struct {
+    uint8_t objId;          // core_msg_obj_t
+    uint8_t msgId;          // command within the object
+    union {
+        struct {
+            uint32_t hz;
+        } freq;
+        struct {
+            uint8_t slot;
+            uint32_t hz;    // CORE_PRESET_STORE only
+        } preset;
+        sweep_config_t sweep;   // CORE_SWEEP_START only
+        struct {
+            uint32_t value;
+        } status;
+    };
+    uint64_t t_input_us;    // time_us_64() of the input behind it, 0 if untraced
+    uint64_t t_queued_us;   // time_us_64() just before the push
+} core_msg_t;
+
+#ifndef CORE_MSG_RING_LEN
+#define CORE_MSG_RING_LEN 16    // power of two
+#endif
+
+// Lock-free single-producer/single-consumer ring, one per direction. Only
+// loads and stores of the two indices, so it works between the cores without
+// a spin lock and without read-modify-write (none on Cortex-M0+).
+typedef struct {
+    core_msg_t ring[CORE_MSG_RING_LEN];
+    atomic_uint head;       // written by the producer
+    atomic_uint tail;       // written by the consumer
+    atomic_uint dropped;    // pushes refused because the ring was full
+    uint32_t coalesce;      // bit objId set: only the newest of a run is delivered
+    uint32_t coalesced;     // messages skipped for a newer one, consumer side
+} core_msg_ring_t;
+
+// coalesce: mask of (1u << objId); of back-to-back messages with the same
+// objId and msgId the consumer then gets only the last one
+void core_msg_ring_init(core_msg_ring_t *r, uint32_t coalesce);
+
+// Producer side: false (and counted in dropped) if the ring is full
+bool core_msg_push(core_msg_ring_t *r, const core_msg_t *m);
+
+// Consumer side: next message, false if the ring is empty
+bool core_msg_pop(core_msg_ring_t *r, core_msg_t *m);
+
+// Handler for one objId; runs in the consumer's context
+typedef void (*core_msg_handler_t)(const core_msg_t *m);
+
+// Consumer side: pops every waiting message and hands it to handlers[objId]
+// (NULL: dropped). Returns how many were popped, so a caller that got 0 can
+// sleep until the producer signals the next push.
+uint32_t core_msg_dispatch(core_msg_ring_t *r, const core_msg_handler_t handlers[CORE_OBJ_COUNT]);
+
+// Messages waiting, as seen from either side
+uint32_t core_msg_pending(core_msg_ring_t *r);
+
+#endif
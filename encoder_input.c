@@ -0,0 +1,58 @@
+#include "encoder_input.h"
+
+void encoder_input_init(encoder_input_t *e, int32_t counts_per_detent,
+                        const encoder_curve_point_t *curve, uint8_t curve_len, uint32_t idle_us) {
+    e->counts_per_detent = counts_per_detent > 0 ? counts_per_detent : 1;
+    e->curve = curve;
+    e->curve_len = curve_len;
+    e->idle_us = idle_us;
+    e->residue = 0;
+    e->last_us = 0;
+    e->rate = 0;
+    e->dir = 0;
+}
+
+uint32_t encoder_input_mult(const encoder_input_t *e, uint32_t rate) {
+    uint32_t mult = 1;
+    for (uint8_t i = 0; i < e->curve_len && rate >= e->curve[i].rate; ++i)
+        mult = e->curve[i].mult;
+    return mult;
+}
+
+int32_t encoder_input_update(encoder_input_t *e, int32_t counts, uint64_t now_us, int32_t *steps) {
+    e->residue += counts;
+    int32_t detents = e->residue / e->counts_per_detent; // toward zero, the rest stays
+    e->residue -= detents * e->counts_per_detent;
+
+    if (!detents) {
+        *steps = 0;
+        return 0;
+    }
+
+    int8_t dir = detents > 0 ? 1 : -1;
+    uint32_t n = detents > 0 ? (uint32_t)detents : (uint32_t)-detents;
+    uint64_t dt = now_us - e->last_us;
+
+    if (dir != e->dir || dt > e->idle_us) {
+        // first detent of a spin: no rate yet
+        e->rate = 0;
+    } else {
+        // several detents in one read share the interval
+        uint32_t inst = (uint32_t)((uint64_t)n * 1000000u / (dt ? dt : 1));
+        e->rate = e->rate ? (3 * e->rate + inst) / 4 : inst;
+    }
+    e->dir = dir;
+    e->last_us = now_us;
+
+    *steps = detents * (int32_t)encoder_input_mult(e, e->rate);
+    return detents;
+}
+
+uint32_t encoder_input_tune(uint32_t value, int32_t steps, uint32_t place, uint32_t max) {
+    int64_t v = (int64_t)value + (int64_t)steps * place;
+    if (v < 0)
+        v = 0;
+    if (v > max)
+        v = max;
+    return (uint32_t)v;
+}
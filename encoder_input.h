@@ -0,0 +1,41 @@
+#ifndef ENCODER_INPUT_H
+#define ENCODER_INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Acceleration curve point: from rate detents per second on, a detent counts mult steps.
+// Points are sorted by rate, the first one should have rate 0.
+typedef struct {
+    uint16_t rate;
+    uint16_t mult;
+} encoder_curve_point_t;
+
+// Turns raw quadrature counts into detents and accelerated steps. Counts that do
+// not make a whole detent yet are kept for the next call; the detent rate is a
+// smoothed average that starts over after a pause or a change of direction.
+typedef struct {
+    int32_t counts_per_detent;
+    const encoder_curve_point_t *curve;
+    uint8_t curve_len;
+    uint32_t idle_us;       // a longer pause between detents ends a spin
+    int32_t residue;        // counts short of a whole detent, sign = direction
+    uint64_t last_us;       // time of the last detent
+    uint32_t rate;          // smoothed detents per second
+    int8_t dir;             // direction of the last detent, 0 before the first
+} encoder_input_t;
+
+void encoder_input_init(encoder_input_t *e, int32_t counts_per_detent,
+                        const encoder_curve_point_t *curve, uint8_t curve_len, uint32_t idle_us);
+
+// Feed the counts read since the last call, taken at now_us. Returns whole detents
+// (negative when turning back); *steps gets them multiplied by the curve.
+int32_t encoder_input_update(encoder_input_t *e, int32_t counts, uint64_t now_us, int32_t *steps);
+
+// Multiplier the curve gives for a detent rate
+uint32_t encoder_input_mult(const encoder_input_t *e, uint32_t rate);
+
+// value + steps * place, carried across digits and clamped to 0..max
+uint32_t encoder_input_tune(uint32_t value, int32_t steps, uint32_t place, uint32_t max);
+
+#endif
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Write the 1-bpp BMPs ssd1306_bench checks tools/bmpconv.py with.
+
+Each sample covers a case image.h does not: a bottom-up and a top-down
+(negative height) row order, the black entry at palette index 1, widths that
+leave row padding and heights that end inside a page. The pixels come from a
+fixed seed, so the output is the same on every run.
+
+Writes DIR/<name>.bmp for bmpconv.py and DIR/bmp_samples.h holding the same
+bytes for ssd1306_bmp_show_image_with_offset().
+
+Usage:
+    bmp_samples.py DIR
+"""
+
+import os
+import random
+import struct
+import sys
+
+# name, width, height (negative: top-down), palette index of black
+SAMPLES = [
+    ("bottom_up_13x11", 13, 11, 0),
+    ("top_down_20x9", 20, -9, 0),
+    ("black_at_1_9x17", 9, 17, 1),
+    ("top_down_black_at_1_40x3", 40, -3, 1),
+]
+
+
+def bmp(width, height, black, rng):
+    stride = ((width + 31) // 32) * 4
+    rows = abs(height)
+    pixels = bytes(rng.getrandbits(8) for _ in range(stride * rows))
+    palette = [b"\0\0\0\0", b"\xff\xff\xff\0"]
+    if black:
+        palette.reverse()
+    off_bits = 14 + 40 + 8
+    info = struct.pack("<IiiHHIIiiII", 40, width, height, 1, 1, 0, len(pixels), 2835, 2835, 2, 2)
+    header = struct.pack("<2sIHHI", b"BM", off_bits + len(pixels), 0, 0, off_bits)
+    return header + info + b"".join(palette) + pixels
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    out = sys.argv[1]
+    os.makedirs(out, exist_ok=True)
+    rng = random.Random(1154)
+    hdr = ["// Generated by host/bmp_samples.py - do not edit", "#ifndef BMP_SAMPLES_H", "#define BMP_SAMPLES_H", "",
+           "#include <stdint.h>", ""]
+    for name, width, height, black in SAMPLES:
+        data = bmp(width, height, black, rng)
+        with open(os.path.join(out, name + ".bmp"), "wb") as f:
+            f.write(data)
+        hdr.append(f"static const uint8_t {name}_bmp[] = {{")
+        for i in range(0, len(data), 16):
+            hdr.append("    " + ",".join(f"0x{v:02x}" for v in data[i:i + 16]) + ",")
+        hdr.append("};")
+        hdr.append("")
+    hdr.append("#endif")
+    with open(os.path.join(out, "bmp_samples.h"), "w") as f:
+        f.write("\n".join(hdr) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "button_gesture.h"
+
+/*
+ * Feeds edge sequences into button_gesture.c the way the button and alarm
+ * IRQs do. After every edge, a tick runs at the deadline it asks for. The
+ * events that come out are checked.
+ */
+
+static const button_gesture_config_t cfg = {
+    .long_us = 600000, .double_us = 300000, .repeat_us = 200000, .click_waits = false,
+};
+
+static int failures;
+
+typedef struct {
+    uint64_t t_us;
+    bool pressed;
+} edge_t;
+
+// run the edges, with ticks at every deadline up to end_us, and collect the event types
+static int run(const button_gesture_config_t *c, const edge_t *edges, int n, uint64_t end_us, char *out) {
+    button_gesture_t g;
+    button_gesture_init(&g, c);
+
+    int i = 0;
+    for (;;) {
+        uint64_t due = button_gesture_deadline(&g);
+        uint64_t next_edge = i < n ? edges[i].t_us : UINT64_MAX;
+        if (due && due <= next_edge && due <= end_us) {
+            button_gesture_tick(&g, due);
+        } else if (i < n) {
+            button_gesture_edge(&g, edges[i].pressed, edges[i].t_us);
+            ++i;
+        } else {
+            break;
+        }
+    }
+
+    static const char code[] = "?CDLR";
+    button_gesture_event_t ev;
+    int k = 0;
+    while (button_gesture_pop(&g, &ev))
+        out[k++] = code[ev.type < 5 ? ev.type : 0];
+    out[k] = 0;
+    return (int)atomic_load(&g.dropped);
+}
+
+static void expect(const char *name, const button_gesture_config_t *c, const edge_t *edges, int n,
+                   uint64_t end_us, const char *want) {
+    char got[64];
+    run(c, edges, n, end_us, got);
+    bool ok = !strcmp(got, want);
+    printf("%-34s %-10s %s\n", name, got, ok ? "ok" : "FAIL");
+    if (!ok) {
+        printf("  expected %s\n", want);
+        ++failures;
+    }
+}
+
+#define N(a) (int)(sizeof(a) / sizeof((a)[0]))
+
+int main(void) {
+    // C click, D double click, L long press, R hold repeat
+    const edge_t click[] = {{1000000, true}, {1120000, false}};
+    const edge_t two_slow[] = {{1000000, true}, {1120000, false}, {1600000, true}, {1700000, false}};
+    const edge_t dbl[] = {{1000000, true}, {1100000, false}, {1250000, true}, {1330000, false}};
+    const edge_t hold[] = {{1000000, true}, {2100000, false}};
+    // second press held 0.8 s: long press at 0.6 s, one repeat at 0.8 s
+    const edge_t click_then_hold[] = {{1000000, true}, {1100000, false}, {1200000, true}, {2000000, false}};
+    const edge_t release_after_long[] = {{1000000, true}, {1650000, false}};
+
+    expect("click", &cfg, click, N(click), 3000000, "C");
+    expect("two clicks, slower than double_us", &cfg, two_slow, N(two_slow), 3000000, "CC");
+    expect("double click", &cfg, dbl, N(dbl), 3000000, "CD");
+    // held 1.1 s: long press at 0.6 s, repeats at 0.8 and 1.0 s
+    expect("long press with hold repeat", &cfg, hold, N(hold), 3000000, "LRR");
+    expect("click, then second press held", &cfg, click_then_hold, N(click_then_hold), 3000000, "CLR");
+    expect("release right after long_us", &cfg, release_after_long, N(release_after_long), 3000000, "L");
+
+    button_gesture_config_t waits = cfg;
+    waits.click_waits = true;
+    expect("click_waits: click after double_us", &waits, click, N(click), 3000000, "C");
+    expect("click_waits: double click only", &waits, dbl, N(dbl), 3000000, "D");
+    expect("click_waits: click, then hold", &waits, click_then_hold, N(click_then_hold), 3000000, "CLR");
+
+    button_gesture_config_t no_double = cfg;
+    no_double.double_us = 0;
+    no_double.repeat_us = 0;
+    expect("no double click, no repeat", &no_double, dbl, N(dbl), 3000000, "CC");
+    expect("long press without repeat", &no_double, hold, N(hold), 3000000, "L");
+
+    // timeouts that were not ticked in time are applied in order by the next edge
+    {
+        button_gesture_t g;
+        button_gesture_init(&g, &cfg);
+        button_gesture_edge(&g, true, 1000000);
+        button_gesture_edge(&g, false, 1700000);  // the tick for 1.6 s never ran
+        button_gesture_event_t ev;
+        bool ok = button_gesture_pop(&g, &ev) && ev.type == BUTTON_LONG_PRESS && ev.t_us == 1600000 &&
+                  !button_gesture_pop(&g, &ev);
+        printf("%-34s %-10s %s\n", "late tick caught up by the edge", "", ok ? "ok" : "FAIL");
+        failures += !ok;
+    }
+
+    // a full queue drops and counts, it never overwrites unread events
+    {
+        edge_t many[2 * (BUTTON_GESTURE_QUEUE_LEN + 3)];
+        for (int i = 0; i < BUTTON_GESTURE_QUEUE_LEN + 3; ++i) {
+            many[2 * i] = (edge_t){1000000 + i * 1000000ull, true};
+            many[2 * i + 1] = (edge_t){1100000 + i * 1000000ull, false};
+        }
+        char got[64];
+        int dropped = run(&cfg, many, N(many), 60000000, got);
+        bool ok = (int)strlen(got) == BUTTON_GESTURE_QUEUE_LEN && dropped == 3;
+        printf("%-34s %-10s %s\n", "queue overflow", got, ok ? "ok" : "FAIL");
+        failures += !ok;
+    }
+
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "core_msg.h"
+
+/*
+ * core_msg.c with the producer and the consumer on two threads, the way
+ * core1 and core0 use it. Every message carries its sequence number in the
+ * payload, spread so that a torn copy shows up. The consumer checks:
+ * - sequence numbers only go up
+ * - every message that cannot coalesce arrives
+ * - a skipped one was a frequency directly followed by another frequency
+ * - the last frequency always arrives
+ *
+ *   core_msg_test [MESSAGES]
+ */
+
+#define FREQ_BASE 1000000u
+
+static core_msg_ring_t ring;
+static uint32_t total = 500000;
+static uint8_t *sent_obj;       // objId by sequence number, written before the push
+
+static uint32_t handled[CORE_OBJ_COUNT];
+
+static void count_freq(const core_msg_t *m) {
+    handled[CORE_OBJ_FREQ] += m->objId == CORE_OBJ_FREQ;
+}
+
+static void count_sweep(const core_msg_t *m) {
+    handled[CORE_OBJ_SWEEP] += m->objId == CORE_OBJ_SWEEP;
+}
+
+static uint32_t seq_of(const core_msg_t *m) {
+    switch (m->objId) {
+    case CORE_OBJ_FREQ:
+        return m->freq.hz - FREQ_BASE;
+    case CORE_OBJ_PRESET:
+        return m->preset.hz;
+    case CORE_OBJ_SWEEP:
+        return m->sweep.start_hz;
+    default:
+        return m->status.value;
+    }
+}
+
+static bool intact(const core_msg_t *m) {
+    switch (m->objId) {
+    case CORE_OBJ_FREQ:
+        return true;
+    case CORE_OBJ_PRESET:
+        return m->preset.slot == (uint8_t)m->preset.hz;
+    case CORE_OBJ_SWEEP:
+        return m->sweep.stop_hz == ~m->sweep.start_hz && m->sweep.dwell_us == m->sweep.start_hz * 3;
+    default:
+        return true;
+    }
+}
+
+static void *producer(void *arg) {
+    uint64_t rng = 88172645463325252ull;
+    for (uint32_t seq = 0; seq < total; ++seq) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+
+        core_msg_t m;
+        memset(&m, 0, sizeof(m));
+        // mostly frequencies in bursts, like a spinning knob, with other objects in between
+        unsigned r = rng % 16;
+        if (r < 10 || seq + 1 == total) {
+            m.objId = CORE_OBJ_FREQ;
+            m.freq.hz = FREQ_BASE + seq;
+        } else if (r < 12) {
+            m.objId = CORE_OBJ_PRESET;
+            m.msgId = CORE_PRESET_STORE;
+            m.preset.hz = seq;
+            m.preset.slot = (uint8_t)seq;
+        } else if (r < 14) {
+            m.objId = CORE_OBJ_SWEEP;
+            m.msgId = CORE_SWEEP_START;
+            m.sweep.start_hz = seq;
+            m.sweep.stop_hz = ~seq;
+            m.sweep.dwell_us = seq * 3;
+        } else {
+            m.objId = CORE_OBJ_STATUS;
+            m.msgId = CORE_STATUS_ERROR;
+            m.status.value = seq;
+        }
+        sent_obj[seq] = m.objId;
+
+        while (!core_msg_push(&ring, &m))
+            sched_yield();
+    }
+    return arg;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+        total = (uint32_t)strtoul(argv[1], NULL, 0);
+    sent_obj = calloc(total, 1);
+    if (!sent_obj || total < 2)
+        return 2;
+
+    core_msg_ring_init(&ring, 1u << CORE_OBJ_FREQ);
+    pthread_t th;
+    pthread_create(&th, NULL, producer, NULL);
+
+    uint32_t received = 0, torn = 0, disorder = 0, last_freq = 0;
+    int64_t expect = 0;     // next sequence number not yet seen
+    uint8_t *seen = calloc(total, 1);
+    for (;;) {
+        core_msg_t m;
+        if (!core_msg_pop(&ring, &m)) {
+            if (expect >= total)
+                break;
+            sched_yield();
+            continue;
+        }
+        uint32_t seq = seq_of(&m);
+        ++received;
+        torn += !intact(&m);
+        if (seq >= total || seq < expect) {
+            ++disorder;
+            continue;
+        }
+        seen[seq] = 1;
+        expect = (int64_t)seq + 1;
+        if (m.objId == CORE_OBJ_FREQ)
+            last_freq = m.freq.hz;
+    }
+    pthread_join(th, NULL);
+
+    // every gap is a frequency that the next message replaced
+    uint32_t lost = 0;
+    for (uint32_t seq = 0; seq < total; ++seq) {
+        if (seen[seq])
+            continue;
+        if (sent_obj[seq] != CORE_OBJ_FREQ || seq + 1 >= total || sent_obj[seq + 1] != CORE_OBJ_FREQ)
+            ++lost;
+    }
+
+    bool ok = !torn && !disorder && !lost && received + ring.coalesced == total &&
+              last_freq == FREQ_BASE + total - 1;
+    printf("%u messages: %u delivered, %u coalesced, %u full-ring retries, %u torn, %u out of order, %u lost\n",
+           total, received, ring.coalesced, atomic_load(&ring.dropped), torn, disorder, lost);
+
+    // single-threaded: a run of frequencies collapses, but not across another object
+    core_msg_ring_init(&ring, 1u << CORE_OBJ_FREQ);
+    const uint8_t objs[] = {CORE_OBJ_FREQ, CORE_OBJ_FREQ, CORE_OBJ_SWEEP, CORE_OBJ_FREQ, CORE_OBJ_FREQ, CORE_OBJ_FREQ};
+    for (uint32_t i = 0; i < sizeof(objs); ++i) {
+        core_msg_t m = {.objId = objs[i]};
+        m.freq.hz = i;  // shares the first word with every payload
+        core_msg_push(&ring, &m);
+    }
+    char got[16] = "";
+    core_msg_t m;
+    for (int n = 0; core_msg_pop(&ring, &m) && n < 15; ++n)
+        got[n] = '0' + m.freq.hz;
+    bool order_ok = !strcmp(got, "125");
+    printf("run of frequencies around a sweep: delivered %s %s\n", got, order_ok ? "ok" : "FAIL (expected 125)");
+
+    // the dispatcher hands each object to its handler and drops the ones without
+    core_msg_ring_init(&ring, 1u << CORE_OBJ_FREQ);
+    for (uint32_t i = 0; i < sizeof(objs); ++i) {
+        core_msg_t m = {.objId = objs[i]};
+        core_msg_push(&ring, &m);
+    }
+    core_msg_t preset = {.objId = CORE_OBJ_PRESET};
+    core_msg_push(&ring, &preset);
+    const core_msg_handler_t handlers[CORE_OBJ_COUNT] = {
+        [CORE_OBJ_FREQ] = count_freq,
+        [CORE_OBJ_SWEEP] = count_sweep,
+    };
+    uint32_t popped = core_msg_dispatch(&ring, handlers);
+    bool dispatch_ok = popped == 4 && handled[CORE_OBJ_FREQ] == 2 && handled[CORE_OBJ_SWEEP] == 1 &&
+                       core_msg_dispatch(&ring, handlers) == 0;
+    printf("dispatch: %u popped, %u freq, %u sweep %s\n", popped, handled[CORE_OBJ_FREQ],
+           handled[CORE_OBJ_SWEEP], dispatch_ok ? "ok" : "FAIL");
+
+    free(seen);
+    free(sent_obj);
+    ok = ok && order_ok && dispatch_ok;
+    printf(ok ? "OK\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "encoder_input.h"
+
+/*
+ * Replays detent timings through encoder_input.c with the curve of
+ * core1_entry.c and checks remainders, reversals, carry and how long a
+ * spin takes across the tuning range.
+ *
+ *   encoder_input_test [TRACE]
+ *
+ * TRACE is a recording, one "<time_us> <counts>" line per encoder read,
+ * e.g. logged from core1. It is replayed on the 100 kHz digit and the steps
+ * per read are printed.
+ */
+
+#define COUNTS_PER_DETENT 4     // ENCODER_STEP_DIVISOR
+#define IDLE_US 250000          // ENCODER_ACCEL_IDLE_US
+#define FREQ_MAX 160000000u
+
+static const encoder_curve_point_t curve[] = {
+    {0, 1}, {6, 2}, {10, 5}, {15, 10}, {20, 25}, {30, 50},
+};
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            ++failures; \
+        } \
+    } while (0)
+
+static void init(encoder_input_t *e) {
+    encoder_input_init(e, COUNTS_PER_DETENT, curve, sizeof(curve) / sizeof(curve[0]), IDLE_US);
+}
+
+// partial counts add up to detents, nothing is thrown away
+static void test_remainder(void) {
+    encoder_input_t e;
+    init(&e);
+    int32_t steps, total = 0;
+    const int32_t reads[] = {1, 1, 1, 1, 3, 2, 2, 1, -1, 5};
+    uint64_t t = 1000000;
+
+    for (size_t i = 0; i < sizeof(reads) / sizeof(reads[0]); ++i, t += 300000)
+        total += encoder_input_update(&e, reads[i], t, &steps);
+    // 1+1+1+1+3+2+2+1-1+5 = 16 counts
+    CHECK(total == 4, "16 counts gave %d detents", total);
+    CHECK(e.residue == 0, "residue %d", e.residue);
+
+    total = encoder_input_update(&e, 3, t, &steps);
+    CHECK(total == 0 && e.residue == 3, "3 counts: %d detents, residue %d", total, e.residue);
+    total = encoder_input_update(&e, -6, t + 300000, &steps);
+    CHECK(total == 0 && e.residue == -3, "back 6: %d detents, residue %d", total, e.residue);
+    printf("remainder kept across reads\n");
+}
+
+// slow clicks are exact, one step each
+static void test_slow_clicks(void) {
+    encoder_input_t e;
+    init(&e);
+    uint32_t freq = 7000000;
+    int32_t steps;
+
+    for (int i = 0; i < 20; ++i) {
+        encoder_input_update(&e, COUNTS_PER_DETENT, 1000000 + i * 300000ull, &steps);
+        CHECK(steps == 1, "click %d gave %d steps", i, steps);
+        freq = encoder_input_tune(freq, steps, 1000, FREQ_MAX);
+    }
+    CHECK(freq == 7020000, "freq %u", freq);
+    printf("slow clicks: 20 detents -> %u Hz\n", freq);
+}
+
+// a reversal starts slow again, even in the middle of a fast spin
+static void test_reversal(void) {
+    encoder_input_t e;
+    init(&e);
+    int32_t steps = 0;
+    uint64_t t = 1000000;
+
+    for (int i = 0; i < 30; ++i, t += 25000)
+        encoder_input_update(&e, COUNTS_PER_DETENT, t, &steps);
+    CHECK(steps >= 25, "40 detents/s spin: %d steps per detent", steps);
+
+    encoder_input_update(&e, -COUNTS_PER_DETENT, t, &steps);
+    CHECK(steps == -1, "first detent back: %d steps", steps);
+    printf("reversal resets the rate\n");
+}
+
+// carry into the higher digits and clamping at the ends
+static void test_carry(void) {
+    CHECK(encoder_input_tune(99999, 1, 1, FREQ_MAX) == 100000, "99999 + 1");
+    CHECK(encoder_input_tune(100000, -1, 1, FREQ_MAX) == 99999, "100000 - 1");
+    CHECK(encoder_input_tune(9900000, 3, 100000, FREQ_MAX) == 10200000, "9.9 MHz + 3 * 100 kHz");
+    CHECK(encoder_input_tune(159000000, 50, 1000000, FREQ_MAX) == FREQ_MAX, "clamp high");
+    CHECK(encoder_input_tune(5000, -50, 1000, FREQ_MAX) == 0, "clamp low");
+    printf("carry across digits and clamping\n");
+}
+
+// steady spin from 8 kHz to 160 MHz on the 100 kHz digit
+static void test_range(void) {
+    const uint32_t rates[] = {5, 12, 20, 25, 35};
+
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r) {
+        encoder_input_t e;
+        init(&e);
+        uint32_t freq = 8000;
+        uint64_t t = 1000000, t0 = t;
+        uint32_t period = 1000000 / rates[r];
+        int32_t steps;
+
+        while (freq < FREQ_MAX && t - t0 < 600000000ull) {
+            encoder_input_update(&e, COUNTS_PER_DETENT, t, &steps);
+            freq = encoder_input_tune(freq, steps, 100000, FREQ_MAX);
+            t += period;
+        }
+        double secs = (t - t0) / 1e6;
+        printf("%2u detents/s on the 100 kHz digit: 8 kHz -> 160 MHz in %6.1f s\n", rates[r], secs);
+        if (rates[r] >= 20)
+            CHECK(secs < 5, "a fast spin takes %.1f s", secs);
+    }
+}
+
+static int replay(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+
+    encoder_input_t e;
+    init(&e);
+    uint32_t freq = 8000;
+    unsigned long long t;
+    long counts;
+    int32_t steps;
+    while (fscanf(f, "%llu %ld", &t, &counts) == 2) {
+        int32_t d = encoder_input_update(&e, (int32_t)counts, t, &steps);
+        freq = encoder_input_tune(freq, steps, 100000, FREQ_MAX);
+        if (d)
+            printf("%12llu us  %3d detents  %4u/s  %5d steps  %9u Hz\n", t, d, e.rate, steps, freq);
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+        return replay(argv[1]);
+
+    test_remainder();
+    test_slow_clicks();
+    test_reversal();
+    test_carry();
+    test_range();
+
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
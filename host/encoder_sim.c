@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Quadrature sequences through a model of encoder/quadrature_encoder.pio
+ * with the DMA copy of the count (quadrature_encoder_start_dma).
+ *
+ * The 16-entry jump table is read from the .pio source, so the model
+ * follows the program. The SM samples the pins once per loop, at worst
+ * every 10 cycles of a clock of 10 * max_step_rate. Each sample is pushed
+ * and copied to the RAM word that the UI reads at random times.
+ *
+ *   encoder_sim [PIO_FILE]
+ *
+ * Exits 1 if a case that the configured step rate should handle loses counts.
+ */
+
+#define MAX_STEP_RATE 20000     // ENCODER_MAX_STEP_RATE in core1_entry.c
+#define SM_LOOP_CYCLES 10       // worst case loop of the program
+
+static int8_t table[16];
+
+static bool load_table(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+
+    char line[256];
+    int n = 0;
+    bool in_program = false, at_decrement = false;
+    while (n < 16 && fgets(line, sizeof(line), f)) {
+        char *s = line;
+        while (*s == ' ' || *s == '\t')
+            ++s;
+        if (!strncmp(s, ".origin", 7)) {
+            in_program = true;
+            continue;
+        }
+        if (!in_program || *s == ';' || *s == '\n' || *s == '.')
+            continue;
+        if (!strncmp(s, "decrement:", 10)) {
+            at_decrement = true;
+            continue;
+        }
+        if (strchr(s, ':') && strchr(s, ':') < (strchr(s, ';') ? strchr(s, ';') : s + strlen(s)))
+            continue; // other labels
+
+        // JMP decrement/increment, or the instruction at the decrement label (JMP Y--)
+        if (at_decrement || strstr(s, "JMP decrement"))
+            table[n] = -1;
+        else if (strstr(s, "JMP increment"))
+            table[n] = 1;
+        else
+            table[n] = 0;
+        at_decrement = false;
+        ++n;
+    }
+    fclose(f);
+    return n == 16;
+}
+
+// pins as the SM reads them (bit 0 A, bit 1 B), in the order that counts up
+static const uint8_t gray[4] = {0, 2, 3, 1};
+
+static uint64_t rng = 88172645463325252ull;
+static uint32_t rnd(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (uint32_t)rng;
+}
+
+typedef struct {
+    const char *name;
+    double step_rate;       // mean quadrature steps per second
+    int direction_changes;  // reversals over the run
+    int bounce;             // percent of steps followed by a contact bounce
+    double sample_rate;     // SM loops per second
+    int32_t start;          // initial count, to cross the int32 wrap
+    bool must_hold;         // counts must not be lost
+} sim_case_t;
+
+static bool run(const sim_case_t *c) {
+    const int steps = 200000;
+    double t = 0, t_sample = 0;
+    double period = 1.0 / c->sample_rate;
+    int phase = 0, dir = 1;
+    uint8_t pins = gray[0], last = gray[0];
+    uint32_t y = (uint32_t)c->start, word = y, seen = y; // Y wraps like the SM register
+    int64_t truth = 0, truth_sampled = 0, ui = 0;
+    uint32_t reads = 0, bad_reads = 0;
+
+    for (int i = 0; i < steps; ++i) {
+        if (c->direction_changes && rnd() % (steps / c->direction_changes) == 0)
+            dir = -dir;
+
+        // spacing between 0.25 and 1.75 times the mean
+        double dt = (0.25 + (rnd() % 1000) / 666.0) / c->step_rate;
+        double t_next = t + dt;
+
+        // the SM samples the pins up to the next edge; every sample reaches the RAM word
+        while (t_sample < t_next) {
+            y += (uint32_t)(int32_t)table[last << 2 | pins];
+            last = pins;
+            word = y;
+            truth_sampled = truth;
+            t_sample += period;
+
+            // the UI loop reads the word now and then: a plain load, the delta survives the wrap
+            if (rnd() % 64 == 0) {
+                ui += (int32_t)(word - seen);
+                seen = word;
+                ++reads;
+                bad_reads += ui != truth_sampled;
+            }
+        }
+
+        t = t_next;
+        phase = (phase + dir) & 3;
+        pins = gray[phase];
+        truth += dir;
+
+        if ((int)(rnd() % 100) < c->bounce) {
+            // the line that just moved chatters back once, seen by one sample
+            y += (uint32_t)(int32_t)table[last << 2 | gray[(phase - dir) & 3]];
+            y += (uint32_t)(int32_t)table[gray[(phase - dir) & 3] << 2 | pins];
+            last = pins;
+            word = y;
+            truth_sampled = truth;
+            t_sample += period;
+        }
+    }
+
+    // one more sample sees the final position
+    y += (uint32_t)(int32_t)table[last << 2 | pins];
+    word = y;
+    ui += (int32_t)(word - seen);
+
+    bool lost = ui != truth || bad_reads;
+    printf("%-26s %6.0f steps/s %6.0f samples/s  moved %7lld counted %7lld  wrong reads %5u/%-5u %s\n",
+           c->name, c->step_rate, c->sample_rate, (long long)truth, (long long)ui, bad_reads, reads,
+           lost ? (c->must_hold ? "LOST" : "lost (expected)") : "ok");
+    return !lost || !c->must_hold;
+}
+
+int main(int argc, char **argv) {
+    const char *pio = argc > 1 ? argv[1] : "../encoder/quadrature_encoder.pio";
+    if (!load_table(pio)) {
+        fprintf(stderr, "cannot read the jump table from %s\n", pio);
+        return 2;
+    }
+
+    // the SM clock is 10 * max_step_rate, one loop takes up to 10 cycles
+    const double sample_rate = 10.0 * MAX_STEP_RATE / SM_LOOP_CYCLES;
+    const sim_case_t cases[] = {
+        {"slow turns",              50,  20,  0, sample_rate, 0,          true},
+        {"fast hand spin",         2000,  10,  0, sample_rate, 0,          true},
+        {"spin with contact bounce", 2000, 10, 20, sample_rate, 0,          true},
+        {"across the int32 wrap",  2000,   0,  0, sample_rate, INT32_MAX - 1000, true},
+        {"at the configured limit", MAX_STEP_RATE / 4, 4, 0, sample_rate, 0, true},
+        {"old max_step_rate=10",    2000,  10,  0, 10.0 * 10 / SM_LOOP_CYCLES, 0, false},
+    };
+
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+        failures += !run(&cases[i]);
+
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
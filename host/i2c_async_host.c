@@ -0,0 +1,111 @@
+#include <string.h>
+
+#include "i2c_async_host.h"
+
+#define HOST_BUSES 2
+
+typedef struct {
+    i2c_inst_t *i2c;
+    uint8_t addr;
+    ssd1306_emu_t *emu;
+    i2c_async_client_stats_t stats[I2C_ASYNC_MAX_CLIENTS];
+} host_bus_t;
+
+static host_bus_t g_bus[HOST_BUSES];
+
+static host_bus_t *bus_of(i2c_inst_t *i2c, bool create) {
+    for (uint32_t i = 0; i < HOST_BUSES; ++i)
+        if (g_bus[i].i2c == i2c)
+            return &g_bus[i];
+    if (!create)
+        return NULL;
+    for (uint32_t i = 0; i < HOST_BUSES; ++i)
+        if (!g_bus[i].i2c) {
+            g_bus[i].i2c = i2c;
+            return &g_bus[i];
+        }
+    return NULL;
+}
+
+void i2c_async_host_attach(i2c_inst_t *i2c, uint8_t addr, ssd1306_emu_t *e) {
+    host_bus_t *b = bus_of(i2c, true);
+    if (!b)
+        return;
+    b->addr = addr;
+    b->emu = e;
+}
+
+void i2c_async_init(i2c_inst_t *i2c, uint16_t *cmd_buf, uint32_t cmd_words) {
+    (void)cmd_buf;
+    (void)cmd_words;
+    bus_of(i2c, true);
+}
+
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    host_bus_t *b = bus_of(i2c, false);
+    if (!b || txn->status == I2C_ASYNC_QUEUED || txn->status == I2C_ASYNC_BUSY)
+        return false;
+    if (txn->client >= I2C_ASYNC_MAX_CLIENTS) {
+        txn->status = I2C_ASYNC_ERROR;
+        return false;
+    }
+
+    i2c_async_client_stats_t *s = &b->stats[txn->client];
+    ++s->transactions;
+
+    if (!b->emu || txn->addr != b->addr || txn->rx_len) {
+        // nobody answers, and the display is write-only
+        ++s->errors;
+        txn->status = I2C_ASYNC_ERROR;
+    } else {
+        // the control byte may sit in hdr or at the start of tx, so decode them as one write
+        static uint8_t wire[0xFF + 0xFFFF];
+        size_t n = 0;
+        if (txn->hdr_len)
+            memcpy(wire, txn->hdr, txn->hdr_len);
+        n = txn->hdr_len;
+        if (txn->tx_len)
+            memcpy(wire + n, txn->tx, txn->tx_len);
+        n += txn->tx_len;
+
+        ssd1306_emu_i2c_write(b->emu, wire, n);
+        s->bytes += n;
+        txn->status = I2C_ASYNC_DONE;
+    }
+
+    if (txn->callback)
+        txn->callback(txn);
+    return true;
+}
+
+bool i2c_async_wait(i2c_async_txn_t *txn) {
+    if (txn->status == I2C_ASYNC_IDLE)
+        return false;
+    return txn->status == I2C_ASYNC_DONE;
+}
+
+bool i2c_async_busy(i2c_inst_t *i2c) {
+    (void)i2c;
+    return false;
+}
+
+bool i2c_async_transfer_blocking(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    if (!i2c_async_submit(i2c, txn))
+        return false;
+    return i2c_async_wait(txn);
+}
+
+void i2c_async_get_stats(i2c_inst_t *i2c, uint8_t client, i2c_async_client_stats_t *stats) {
+    host_bus_t *b = bus_of(i2c, false);
+    if (!b || client >= I2C_ASYNC_MAX_CLIENTS) {
+        *stats = (i2c_async_client_stats_t){0};
+        return;
+    }
+    *stats = b->stats[client];
+}
+
+void i2c_async_reset_stats(i2c_inst_t *i2c) {
+    host_bus_t *b = bus_of(i2c, false);
+    if (b)
+        memset(b->stats, 0, sizeof(b->stats));
+}
@@ -0,0 +1,16 @@
+#ifndef I2C_ASYNC_HOST_H
+#define I2C_ASYNC_HOST_H
+
+#include "i2c_async.h"
+#include "ssd1306_emu.h"
+
+/*
+ * Host replacement for i2c_async.c: transactions finish inside
+ * i2c_async_submit(), writes to the attached address are decoded by the
+ * emulator, the statistics count them like the DMA transport does.
+ */
+
+// Route writes to addr on i2c into e (NULL detaches: the address NACKs)
+void i2c_async_host_attach(i2c_inst_t *i2c, uint8_t addr, ssd1306_emu_t *e);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include <stdbool.h>
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+
+// Output levels are kept by the fake SPI (spi_host.c), which samples D/C# and CS#
+void gpio_init(unsigned gpio);
+void gpio_set_dir(unsigned gpio, bool out);
+void gpio_put(unsigned gpio, bool value);
+
+#endif
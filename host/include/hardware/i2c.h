@@ -0,0 +1,11 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+// Opaque on the host too; the fake transport (i2c_async_host.c) only compares pointers
+typedef struct i2c_inst i2c_inst_t;
+
+// Si5351.c talks to i2c0 directly; the instance is defined by si5351_host.c
+extern struct i2c_inst host_i2c0_inst;
+#define i2c0 (&host_i2c0_inst)
+
+#endif
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "latency.h"
+
+/*
+ * Feeds known stage times through latency.c and checks the counts, min,
+ * mean, max and that p99 lands in the right bucket. The table that core0
+ * prints on 'l' is printed at the end.
+ */
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            ++failures; \
+        } \
+    } while (0)
+
+static void trace(latency_stats_t *s, uint64_t t0, uint32_t queue, uint32_t wake, uint32_t plan, uint32_t i2c) {
+    latency_trace_t t = {.input = t0};
+    t.queued = t.input + queue;
+    t.dequeued = t.queued + wake;
+    t.planned = t.dequeued + plan;
+    t.done = t.planned + i2c;
+    latency_record(s, &t);
+}
+
+int main(void) {
+    static latency_stats_t s;
+    latency_reset(&s);
+
+    // 99 fast wake-ups and one slow one, as if core0 still polled now and then
+    for (int i = 0; i < 1000; ++i)
+        trace(&s, 1000000 + i * 10000ull, 5000 + i % 7, i % 100 == 99 ? 100000 : 3, 40 + i % 20, 900);
+
+    const latency_hist_t *w = &s.stage[LATENCY_WAKE];
+    CHECK(w->count == 1000, "count %u", w->count);
+    CHECK(w->min_us == 3 && w->max_us == 100000, "min %u max %u", w->min_us, w->max_us);
+    CHECK(w->sum_us / w->count == (990 * 3 + 10 * 100000) / 1000, "mean %llu", (unsigned long long)(w->sum_us / w->count));
+    CHECK(latency_percentile(w, 990) == 3, "p99 %u, the slow 1%% must not show", latency_percentile(w, 990));
+    CHECK(latency_percentile(w, 995) == 100000, "p99.5 %u", latency_percentile(w, 995));
+
+    // above 8 us the percentile is the top of a bucket at most 25% wide
+    const latency_hist_t *p = &s.stage[LATENCY_PLAN];
+    uint32_t p99 = latency_percentile(p, 990);
+    CHECK(p99 >= 59 && p99 <= 59 * 5 / 4, "plan p99 %u, want 59..73", p99);
+    CHECK(p->min_us == 40 && p->max_us == 59, "plan min %u max %u", p->min_us, p->max_us);
+
+    const latency_hist_t *t = &s.stage[LATENCY_TOTAL];
+    CHECK(t->min_us == 5000 + 3 + 40 + 900, "total min %u", t->min_us);
+    CHECK(t->max_us >= 5000 + 100000 + 900, "total max %u", t->max_us);
+
+    // stamps that went backwards count as 0, far ones land in the last bucket
+    latency_stats_t odd;
+    latency_reset(&odd);
+    latency_trace_t back = {.input = 500, .queued = 400, .dequeued = 400, .planned = 400, .done = 60000000000ull};
+    latency_record(&odd, &back);
+    CHECK(odd.stage[LATENCY_QUEUE].max_us == 0, "backwards stamp gave %u", odd.stage[LATENCY_QUEUE].max_us);
+    CHECK(odd.stage[LATENCY_I2C].hist[LATENCY_BUCKETS - 1] == 1, "60 s not in the last bucket");
+    CHECK(latency_percentile(&odd.stage[LATENCY_I2C], 990) == odd.stage[LATENCY_I2C].max_us, "clamped to max");
+
+    latency_reset(&s);
+    CHECK(s.stage[LATENCY_TOTAL].count == 0 && latency_percentile(&s.stage[LATENCY_TOTAL], 990) == 0, "reset");
+
+    trace(&s, 1000000, 4200, 2, 35, 1150);
+    latency_dump(&s);
+
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
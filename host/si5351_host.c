@@ -0,0 +1,89 @@
+#include <string.h>
+
+#include "si5351_host.h"
+
+#define SI5351_ADDR 0x60
+#define REG_PLL_RESET 177
+
+struct i2c_inst {
+    int unused;
+};
+struct i2c_inst host_i2c0_inst;
+
+si5351_host_t si5351_host;
+static i2c_async_client_stats_t g_stats[I2C_ASYNC_MAX_CLIENTS];
+
+void si5351_host_reset(void) {
+    memset(&si5351_host, 0, sizeof(si5351_host));
+}
+
+void si5351_host_reset_counts(void) {
+    memset(si5351_host.writes, 0, sizeof(si5351_host.writes));
+    si5351_host.transactions = 0;
+    si5351_host.bytes = 0;
+    si5351_host.pll_resets = 0;
+}
+
+void i2c_async_init(i2c_inst_t *i2c, uint16_t *cmd_buf, uint32_t cmd_words) {
+    (void)i2c;
+    (void)cmd_buf;
+    (void)cmd_words;
+}
+
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    if (i2c != i2c0 || txn->status == I2C_ASYNC_QUEUED || txn->status == I2C_ASYNC_BUSY)
+        return false;
+    if (txn->client >= I2C_ASYNC_MAX_CLIENTS) {
+        txn->status = I2C_ASYNC_ERROR;
+        return false;
+    }
+
+    i2c_async_client_stats_t *s = &g_stats[txn->client];
+    ++s->transactions;
+    if (txn->addr != SI5351_ADDR || txn->hdr_len != 1 || txn->rx_len) {
+        // only register writes are modelled
+        ++s->errors;
+        txn->status = I2C_ASYNC_ERROR;
+    } else {
+        uint8_t reg = txn->hdr[0];
+        for (uint16_t i = 0; i < txn->tx_len; ++i, ++reg) {
+            si5351_host.regs[reg] = txn->tx[i];
+            ++si5351_host.writes[reg];
+            if (reg == REG_PLL_RESET) {
+                si5351_host.last_pll_reset = txn->tx[i];
+                ++si5351_host.pll_resets;
+            }
+        }
+        ++si5351_host.transactions;
+        si5351_host.bytes += 1u + txn->tx_len;
+        s->bytes += 1u + txn->tx_len;
+        txn->status = I2C_ASYNC_DONE;
+    }
+
+    if (txn->callback)
+        txn->callback(txn);
+    return true;
+}
+
+bool i2c_async_wait(i2c_async_txn_t *txn) {
+    return txn->status == I2C_ASYNC_DONE;
+}
+
+bool i2c_async_busy(i2c_inst_t *i2c) {
+    (void)i2c;
+    return false;
+}
+
+bool i2c_async_transfer_blocking(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    return i2c_async_submit(i2c, txn) && i2c_async_wait(txn);
+}
+
+void i2c_async_get_stats(i2c_inst_t *i2c, uint8_t client, i2c_async_client_stats_t *stats) {
+    (void)i2c;
+    *stats = client < I2C_ASYNC_MAX_CLIENTS ? g_stats[client] : (i2c_async_client_stats_t){0};
+}
+
+void i2c_async_reset_stats(i2c_inst_t *i2c) {
+    (void)i2c;
+    memset(g_stats, 0, sizeof(g_stats));
+}
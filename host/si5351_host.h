@@ -0,0 +1,31 @@
+#ifndef SI5351_HOST_H
+#define SI5351_HOST_H
+
+#include <stdint.h>
+
+#include "i2c_async.h"
+
+/*
+ * Host replacement for i2c_async.c with a Si5351 register file behind it:
+ * transactions finish inside i2c_async_submit(), a write to 0x60 stores its
+ * bytes from the register in hdr on, with auto-increment.
+ */
+
+typedef struct {
+    uint8_t regs[256];
+    uint32_t writes[256];   // bytes written per register
+    uint32_t transactions;
+    uint32_t bytes;         // register byte included
+    uint8_t last_pll_reset; // last value written to register 177
+    uint32_t pll_resets;    // writes to register 177
+} si5351_host_t;
+
+extern si5351_host_t si5351_host;
+
+// Power-on state: all registers 0, counters cleared
+void si5351_host_reset(void);
+
+// Clears only the counters
+void si5351_host_reset_counts(void);
+
+#endif
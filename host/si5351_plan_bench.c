@@ -0,0 +1,130 @@
+#define _POSIX_C_SOURCE 199309L  // clock_gettime under -std=c11
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "Si5351.h"
+
+/*
+ * Plans random CLK0 frequencies between 8 kHz and 160 MHz with si5351_plan()
+ * and reports plans per second and the worst error. Every plan is checked:
+ * - the VCO stays within 600..900 MHz, PLL a within 15..90
+ * - MS is an integer 6..2048, 4 with DIVBY4, or a fraction 8..2048
+ * - the register image from si5351_clk0_build(), decoded as the chip does,
+ *   gives achieved_mhz
+ *
+ *   si5351_plan_bench [COUNT]
+ *
+ * Exits 1 if a plan is illegal or the worst error is above MAX_ERR_MHZ.
+ */
+
+#define XTAL_HZ 25000000u       // SI5351_XTAL_HZ
+#define MAX_ERR_MHZ 1000        // 1 Hz
+
+typedef unsigned __int128 u128;
+
+static uint64_t rng = 88172645463325252ull;
+static uint32_t rnd(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (uint32_t)rng;
+}
+
+// divider from 8 registers (AN619): (P1 + 512 + P2/P3) / 128 = num / den
+static void decode_ms(const uint8_t r[8], uint64_t *num, uint64_t *den) {
+    uint32_t p3 = (uint32_t)(r[5] >> 4) << 16 | (uint32_t)r[0] << 8 | r[1];
+    uint32_t p1 = (uint32_t)(r[2] & 3) << 16 | (uint32_t)r[3] << 8 | r[4];
+    uint32_t p2 = (uint32_t)(r[5] & 15) << 16 | (uint32_t)r[6] << 8 | r[7];
+    *num = (uint64_t)p3 * (p1 + 512) + p2;
+    *den = (uint64_t)128 * p3;
+}
+
+static int failures;
+
+static void check(uint32_t f, const si5351_plan_t *p, uint32_t *worst, uint32_t *worst_f) {
+    uint64_t pll_num = (uint64_t)p->pll.a * p->pll.c + p->pll.b;
+    u128 vco_mhz = (u128)XTAL_HZ * 1000 * pll_num / p->pll.c;
+    bool ok = vco_mhz >= (u128)600000000 * 1000 && vco_mhz <= (u128)900000000 * 1000 &&
+              p->pll.a >= 15 && p->pll.a <= 90 && p->pll.b < p->pll.c && p->pll.c <= 1048575;
+    if (p->divby4)
+        ok = ok && p->ms.a == 4 && p->ms.b == 0;
+    else if (p->ms.b == 0)
+        ok = ok && p->ms.a >= 6 && p->ms.a <= 2048;
+    else
+        ok = ok && p->ms.a >= 8 && p->ms.a < 2048 && p->ms.b < p->ms.c && p->ms.c <= 1048575;
+
+    si5351_clk0_regs_t regs;
+    si5351_clk0_build(p, &regs);
+    uint64_t n_num, n_den, m_num, m_den;
+    decode_ms(regs.msna, &n_num, &n_den);
+    bool divby4 = (regs.ms0[2] & 0x0C) == 0x0C;
+    uint32_t rdiv = (regs.ms0[2] >> 4) & 7;
+    if (divby4) {
+        m_num = 4;
+        m_den = 1;
+    } else {
+        decode_ms(regs.ms0, &m_num, &m_den);
+    }
+    u128 q = (u128)n_den * m_num << rdiv;
+    uint64_t fout_mhz = (uint64_t)(((u128)XTAL_HZ * 1000 * n_num * m_den + q / 2) / q);
+    // the planner rounds twice (VCO, then output), so allow 1 mHz
+    uint64_t d = fout_mhz > p->achieved_mhz ? fout_mhz - p->achieved_mhz : p->achieved_mhz - fout_mhz;
+    ok = ok && d <= 1 && divby4 == p->divby4 && rdiv == p->rdiv;
+
+    if (!ok) {
+        printf("  %u Hz: illegal plan (pll %u+%u/%u ms %u+%u/%u r%u%s) or registers give %llu mHz, plan %llu mHz\n",
+               f, p->pll.a, p->pll.b, p->pll.c, p->ms.a, p->ms.b, p->ms.c, p->rdiv, p->divby4 ? " divby4" : "",
+               (unsigned long long)fout_mhz, (unsigned long long)p->achieved_mhz);
+        ++failures;
+    }
+    uint32_t err = (uint32_t)(p->error_mhz < 0 ? -p->error_mhz : p->error_mhz);
+    if (err > *worst) {
+        *worst = err;
+        *worst_f = f;
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t count = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000;
+    uint32_t *freqs = malloc(sizeof(uint32_t) * (count + 8));
+    si5351_plan_t *plans = malloc(sizeof(si5351_plan_t) * (count + 8));
+    if (!freqs || !plans)
+        return 2;
+
+    // the ends of the range and of the DIVBY4 band, then uniform random
+    const uint32_t edges[] = {8000, 8001, 150000000, 150000001, 160000000, 112500001, 7000000, 10000000};
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i)
+        freqs[n++] = edges[i];
+    for (uint32_t i = 0; i < count; ++i)
+        freqs[n++] = 8000 + rnd() % (160000000 - 8000 + 1);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (!si5351_plan(freqs[i], &plans[i])) {
+            printf("  %u Hz: no plan\n", freqs[i]);
+            ++failures;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    uint32_t worst = 0, worst_f = 0;
+    for (uint32_t i = 0; i < n; ++i)
+        check(freqs[i], &plans[i], &worst, &worst_f);
+
+    printf("%u plans in %.3f s, %.0f plans/s on this host; worst error %u mHz at %u Hz\n",
+           n, secs, n / secs, worst, worst_f);
+    if (worst > MAX_ERR_MHZ) {
+        printf("  worst error above %u mHz\n", MAX_ERR_MHZ);
+        ++failures;
+    }
+
+    free(freqs);
+    free(plans);
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "Si5351.h"
+#include "si5351_host.h"
+
+/*
+ * Si5351.c against a register file (si5351_host.c): what the chip holds
+ * after each call is compared with what a fresh calculation says it should
+ * hold.
+ */
+
+#define CACHE_SIZE 8    // SI5351_CACHE_SIZE
+#define REG_MSNA 26
+#define REG_MS0 42
+#define REG_CLK0_CTRL 16
+#define PLL_RESET_A 0x20
+#define CLKx_PDN 0x80
+#define CLKx_SRC_PLLB 0x20
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            ++failures; \
+        } \
+    } while (0)
+
+static void power_on(void) {
+    si5351_host_reset();
+    si5351_shadow_invalidate();
+    si5351_cache_flush();
+    si5351_vco_unpin();
+    si5351_init();
+}
+
+// chip registers of CLK0 equal si5351_clk0_calc(f)
+static bool chip_holds(uint32_t f) {
+    si5351_clk0_regs_t want;
+    if (!si5351_clk0_calc(f, &want))
+        return false;
+    return !memcmp(&si5351_host.regs[REG_MSNA], want.msna, 8) && !memcmp(&si5351_host.regs[REG_MS0], want.ms0, 8) &&
+           si5351_host.regs[REG_CLK0_CTRL] == want.clk0;
+}
+
+static void set(uint32_t f) {
+    CHECK(si5351_clk0_set(f), "si5351_clk0_set(%u)", f);
+}
+
+// a cache hit leaves the same registers as a fresh calculation
+static void test_cache_hit_registers(void) {
+    const uint32_t freqs[] = {7000000, 14250000, 8000, 150000001, 160000000, 1234567, 99999999};
+    power_on();
+    for (size_t i = 0; i < count_of(freqs); ++i) {
+        set(freqs[i]);
+        CHECK(chip_holds(freqs[i]), "miss for %u Hz", freqs[i]);
+    }
+
+    si5351_cache_stats_t st;
+    si5351_cache_get_stats(&st);
+    CHECK(st.hits == 0 && st.misses == count_of(freqs), "hits %u misses %u", st.hits, st.misses);
+
+    // every one again, in a different order so each hit follows another frequency
+    for (size_t i = count_of(freqs); i-- > 0;) {
+        set(freqs[i]);
+        CHECK(chip_holds(freqs[i]), "hit for %u Hz", freqs[i]);
+    }
+    si5351_cache_get_stats(&st);
+    CHECK(st.hits == count_of(freqs), "hits %u", st.hits);
+
+    // a hit after the shadow was lost rewrites everything, still identical
+    si5351_host_reset();
+    si5351_shadow_invalidate();
+    set(freqs[0]);
+    CHECK(chip_holds(freqs[0]), "hit after power loss");
+    printf("cache hits write the registers of a fresh calculation\n");
+}
+
+// the least recently used entry goes first, flush empties the cache
+static void test_lru_and_flush(void) {
+    power_on();
+    si5351_cache_stats_t st;
+    for (uint32_t i = 0; i < CACHE_SIZE; ++i)
+        set(1000000 + i * 1000);
+    set(1000000);                       // hit, now the most recent
+    set(1000000 + CACHE_SIZE * 1000);   // evicts 1001000, the oldest
+    si5351_cache_get_stats(&st);
+    CHECK(st.hits == 1 && st.misses == CACHE_SIZE + 1, "fill: hits %u misses %u", st.hits, st.misses);
+
+    set(1001000);                       // was evicted: miss, evicts 1002000
+    set(1000000);                       // kept: hit
+    set(1003000);                       // kept: hit
+    si5351_cache_get_stats(&st);
+    CHECK(st.hits == 3 && st.misses == CACHE_SIZE + 2, "lru: hits %u misses %u", st.hits, st.misses);
+    set(1002000);
+    si5351_cache_get_stats(&st);
+    CHECK(st.misses == CACHE_SIZE + 3, "1002000 should have been evicted");
+    CHECK(chip_holds(1002000), "registers after eviction");
+
+    si5351_cache_flush();
+    si5351_cache_get_stats(&st);
+    CHECK(st.hits == 0 && st.misses == 0, "flush keeps counters");
+    set(1000000);
+    set(1003000);
+    si5351_cache_get_stats(&st);
+    CHECK(st.hits == 0 && st.misses == 2, "after flush: hits %u misses %u", st.hits, st.misses);
+    CHECK(chip_holds(1003000), "registers after flush");
+    printf("LRU eviction and flush\n");
+}
+
+// a new CLK0 VCO resets PLLA only
+static void test_clk0_resets_plla_only(void) {
+    power_on();
+    set(7000000);
+    CHECK(si5351_host.pll_resets == 1 && si5351_host.last_pll_reset == PLL_RESET_A,
+          "%u resets, last 0x%02x", si5351_host.pll_resets, si5351_host.last_pll_reset);
+    set(145000000);
+    CHECK(si5351_host.pll_resets == 2 && si5351_host.last_pll_reset == PLL_RESET_A,
+          "%u resets, last 0x%02x", si5351_host.pll_resets, si5351_host.last_pll_reset);
+
+    // the async half reports the reset it queued
+    bool reset = false;
+    CHECK(si5351_clk0_set_async(7000000, &reset) && reset && si5351_finish(reset), "async with a new VCO");
+    CHECK(si5351_clk0_set_async(7000000, &reset) && !reset && si5351_finish(reset), "async, same VCO");
+    CHECK(si5351_host.pll_resets == 3, "%u resets", si5351_host.pll_resets);
+    printf("CLK0 resets PLLA only\n");
+}
+
+// while CLK1 runs on PLLA, CLK0 may only change MS0
+static void test_shared_plla(void) {
+    power_on();
+    const uint32_t f[SI5351_NUM_OUTPUTS] = {10000000, 20000000, 0};
+    CHECK(si5351_multi_set(f), "multi_set");
+    CHECK(!(si5351_host.regs[REG_CLK0_CTRL + 1] & (CLKx_PDN | CLKx_SRC_PLLB)), "CLK1 not on PLLA");
+
+    uint8_t msna[8], clk1[9];
+    memcpy(msna, &si5351_host.regs[REG_MSNA], 8);
+    memcpy(clk1, &si5351_host.regs[REG_MS0 + 8], 8);
+    clk1[8] = si5351_host.regs[REG_CLK0_CTRL + 1];
+    si5351_host_reset_counts();
+
+    set(7000000);
+    CHECK(si5351_last_tune_path() == SI5351_TUNE_MS_ONLY, "7 MHz not from the shared VCO");
+    CHECK(si5351_host.pll_resets == 0, "PLL reset with CLK1 on PLLA");
+    CHECK(si5351_clk0_get_hz() == 7000000, "CLK0 %u Hz", si5351_clk0_get_hz());
+
+    // DIVBY4 needs its own VCO: refused
+    CHECK(!si5351_clk0_set(155000000), "155 MHz would retune CLK1");
+    si5351_clk0_regs_t regs;
+    si5351_clk0_calc(155000000, &regs);
+    CHECK(!si5351_clk0_apply(&regs, 155000000, NULL), "image with a new MSNA applied");
+
+    CHECK(!memcmp(msna, &si5351_host.regs[REG_MSNA], 8), "MSNA changed under CLK1");
+    CHECK(!memcmp(clk1, &si5351_host.regs[REG_MS0 + 8], 8) && clk1[8] == si5351_host.regs[REG_CLK0_CTRL + 1],
+          "CLK1 changed");
+    CHECK(si5351_host.pll_resets == 0, "PLL reset with CLK1 on PLLA");
+
+    // an image on the shared VCO still goes through
+    si5351_multi_plan_t mp;
+    si5351_plan_t plan;
+    bool reset = true;
+    CHECK(si5351_multi_plan(f, &mp) && si5351_plan_from_vco(&mp.pll[0], 8000000, &plan), "8 MHz plan");
+    si5351_clk0_build(&plan, &regs);
+    CHECK(si5351_clk0_apply(&regs, 8000000, &reset) && !reset, "image on the shared VCO refused");
+
+    // si5351_init() switches CLK1 off, CLK0 is free again
+    CHECK(si5351_init(), "init");
+    set(155000000);
+    CHECK(si5351_host.last_pll_reset == PLL_RESET_A, "reset 0x%02x", si5351_host.last_pll_reset);
+    printf("CLK0 keeps PLLA while CLK1 runs on it\n");
+}
+
+// a disabled output with an unknown divider is not written
+static void test_multi_set_unknown_gap(void) {
+    power_on();
+    const uint32_t f[SI5351_NUM_OUTPUTS] = {10000000, 0, 27000000};
+    CHECK(si5351_multi_set(f), "multi_set");
+    for (int r = REG_MS0 + 8; r < REG_MS0 + 16; ++r)
+        CHECK(si5351_host.writes[r] == 0, "MS1 register %d written with an unknown value", r);
+    CHECK(si5351_host.writes[REG_MS0] == 1 && si5351_host.writes[REG_MS0 + 16] == 1, "MS0/MS2 not written");
+    CHECK(si5351_host.regs[REG_CLK0_CTRL + 1] == CLKx_PDN, "CLK1 not powered down");
+    printf("multi_set skips an unknown MS1\n");
+}
+
+static bool exact_integer(const si5351_plan_t *p) {
+    return p->ms.b == 0 && p->error_mhz == 0;
+}
+
+// an output without an exact integer plan does not take a PLL from one that has it
+static void test_multi_plan_prefers_integer(void) {
+    // 99999999 Hz has no exact plan; 7.85 MHz and 15 MHz have, but on different VCOs
+    const uint32_t f[SI5351_NUM_OUTPUTS] = {99999999, 7850000, 15000000};
+    si5351_plan_t own;
+    CHECK(si5351_plan(f[0], &own) && !exact_integer(&own), "99999999 Hz has an exact plan");
+    si5351_multi_plan_t mp;
+    CHECK(si5351_multi_plan(f, &mp), "multi_plan");
+    CHECK(exact_integer(&mp.out[1]) && exact_integer(&mp.out[2]), "CLK1/CLK2 pushed onto a fractional MS");
+    CHECK(mp.src[1] != mp.src[2], "CLK1 and CLK2 on one PLL");
+
+    // none of them exact: each PLL still runs one of them on its own plan
+    const uint32_t g[SI5351_NUM_OUTPUTS] = {100000001, 99999999, 0};
+    CHECK(si5351_multi_plan(g, &mp), "multi_plan");
+    for (int i = 0; i < 2; ++i) {
+        CHECK(si5351_plan(g[i], &own), "plan %u", g[i]);
+        CHECK(mp.src[i] == i && mp.out[i].error_mhz == own.error_mhz, "CLK%d: PLL %u, error %d mHz, own %d mHz",
+              i, mp.src[i], mp.out[i].error_mhz, own.error_mhz);
+    }
+    printf("multi_plan keeps exact integer outputs integer\n");
+}
+
+int main(void) {
+    test_cache_hit_registers();
+    test_lru_and_flush();
+    test_clk0_resets_plla_only();
+    test_shared_plla();
+    test_multi_set_unknown_gap();
+    test_multi_plan_prefers_integer();
+
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+#include <string.h>
+
+#include "hardware/gpio.h"
+#include "spi_host.h"
+
+#define HOST_GPIOS 30
+
+static bool g_level[HOST_GPIOS];
+
+static struct {
+    spi_inst_t *spi;
+    unsigned dc, cs, rst;
+    ssd1306_emu_t *emu;
+    spi_host_stats_t stats;
+} g_spi;
+
+void spi_host_attach(spi_inst_t *spi, unsigned dc_pin, unsigned cs_pin, unsigned rst_pin, ssd1306_emu_t *e) {
+    g_spi.spi = spi;
+    g_spi.dc = dc_pin;
+    g_spi.cs = cs_pin;
+    g_spi.rst = rst_pin;
+    g_spi.emu = e;
+}
+
+void spi_host_get_stats(spi_host_stats_t *stats) {
+    *stats = g_spi.stats;
+}
+
+void spi_host_reset_stats(void) {
+    memset(&g_spi.stats, 0, sizeof(g_spi.stats));
+}
+
+void gpio_init(unsigned gpio) {
+    if (gpio < HOST_GPIOS)
+        g_level[gpio] = false;
+}
+
+void gpio_set_dir(unsigned gpio, bool out) {
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_put(unsigned gpio, bool value) {
+    if (gpio >= HOST_GPIOS)
+        return;
+    // rising edge on RES# after it was held low resets the controller
+    if (g_spi.emu && gpio == g_spi.rst && value && !g_level[gpio]) {
+        ssd1306_emu_reset(g_spi.emu);
+        ++g_spi.stats.resets;
+    }
+    g_level[gpio] = value;
+}
+
+void spi_set_format(spi_inst_t *spi, unsigned data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+    (void)spi;
+    (void)data_bits;
+    (void)cpol;
+    (void)cpha;
+    (void)order;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    if (spi != g_spi.spi || !g_spi.emu || g_level[g_spi.cs])
+        return (int)len; // nobody selected
+
+    ++g_spi.stats.writes;
+    g_spi.stats.bytes += len;
+    if (g_level[g_spi.dc])
+        ssd1306_emu_data(g_spi.emu, src, len);
+    else
+        for (size_t i = 0; i < len; ++i)
+            ssd1306_emu_command(g_spi.emu, src[i]);
+    return (int)len;
+}
@@ -0,0 +1,25 @@
+#ifndef SPI_HOST_H
+#define SPI_HOST_H
+
+#include "hardware/spi.h"
+#include "ssd1306_emu.h"
+
+/*
+ * Host replacement for the SPI and GPIO functions the SSD1306 SPI backend
+ * uses. Bytes written while CS# is low go to the emulator as commands or
+ * data, depending on the D/C# level.
+ */
+
+typedef struct {
+    uint32_t writes;    // spi_write_blocking calls with CS# low
+    uint32_t bytes;
+    uint32_t resets;    // RES# pulses
+} spi_host_stats_t;
+
+// Wire the display on spi with the given control GPIOs to e; the emulator is reset with RES#
+void spi_host_attach(spi_inst_t *spi, unsigned dc_pin, unsigned cs_pin, unsigned rst_pin, ssd1306_emu_t *e);
+
+void spi_host_get_stats(spi_host_stats_t *stats);
+void spi_host_reset_stats(void);
+
+#endif
@@ -0,0 +1,426 @@
+#define _POSIX_C_SOURCE 199309L  // clock_gettime under -std=c11
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ssd1306.h"
+#include "ssd1306_emu.h"
+#include "i2c_async_host.h"
+
+#include "BMSPA_font.h"
+#include "acme_5_outlines_font.h"
+#include "bubblesstandard_font.h"
+#include "crackers_font.h"
+#include "fonts_all.h"
+#include "images_all.h"
+#include "bmp_samples.h"
+#include "image.h"
+
+/*
+ * Times the drawing primitives of ssd1306.c against pixel-by-pixel versions
+ * of the same shapes, the way they were drawn before, and checks on random
+ * (also clipped) arguments that both leave the same frame buffer:
+ * - filled and cleared squares, horizontal and vertical lines, empty squares
+ * - images drawn and copied at any y, not only on page boundaries
+ * - text: glyph columns blitted into the pages, against one square per
+ *   font pixel, with all five fonts at scales 1..5; timed per string for
+ *   font_8x5 and bubblesstandard_font, and for the nine digits of the
+ *   frequency display at scale 2
+ * - page-aligned fonts of tools/fontconv.py (fonts_all.c: every font in the
+ *   fixed or trimmed layout, RLE coded at scales 1 and 2 and pre-scaled by 3) against
+ *   ssd1306_draw_string_with_font with the font they were made from
+ * - images of tools/bmpconv.py (images_all.c: image.h and the samples of
+ *   bmp_samples.py) drawn with ssd1306_draw_image, against
+ *   ssd1306_bmp_show_image_with_offset on the BMP, at every y and every
+ *   third x, clipped at the right and bottom edges
+ * Sloped lines are Bresenham now and the float version truncated, so they
+ * are only timed; the check is that a line has max(|dx|, |dy|) + 1 pixels,
+ * both ends, and the same pixels when drawn the other way.
+ *
+ *   ssd1306_bench [ROUNDS]
+ *
+ * Exits 1 if an output differs.
+ */
+
+#define WIDTH  128
+#define HEIGHT 64
+#define ADDR   0x3C
+#define ARGS   4096
+
+extern const uint8_t font_8x5[];    // defined in ssd1306.c through font.h
+
+static const uint8_t *const fonts[] = {font_8x5, BMSPA_font, acme_font, bubblesstandard_font, crackers_font};
+static const char *const font_names[] = {"font_8x5", "BMSPA", "acme", "bubblesstandard", "crackers"};
+
+static const char *text = "14250000 Hz";
+
+typedef struct {
+    const char *name;
+    const ssd1306_pfont_t *pfont;
+    int32_t font;       // index into fonts
+    int32_t scale;
+} pfont_case_t;
+
+#define PFONTS(pf, i) \
+    {#pf "_pf1", &pf##_pf1, i, 1}, {#pf "_pf1_rle", &pf##_pf1_rle, i, 1}, \
+    {#pf "_pf2_rle", &pf##_pf2_rle, i, 2}, {#pf "_pf3", &pf##_pf3, i, 3}
+
+static const pfont_case_t pfonts[] = {
+    PFONTS(font_8x5, 0), PFONTS(BMSPA_font, 1), PFONTS(acme_font, 2),
+    PFONTS(bubblesstandard_font, 3), PFONTS(crackers_font, 4),
+};
+
+typedef struct {
+    int32_t x, y, a, b;
+} args_t;
+
+typedef void (*draw_fn)(ssd1306_t *p, const args_t *a);
+
+static uint32_t rng = 2463534242u;
+static uint32_t rnd(uint32_t n) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+static int failures;
+
+// 13 x 11, two pages: a border and a diagonal
+static const uint8_t tile_data[] = {
+    0xFF, 0x03, 0x05, 0x09, 0x11, 0x21, 0x41, 0x81, 0x01, 0x01, 0x01, 0x01, 0xFF,
+    0x07, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x05, 0x06, 0x04, 0x04, 0x07,
+};
+static const ssd1306_image_t tile = {.width = 13, .height = 11, .data = tile_data};
+
+static void pixel_at(ssd1306_t *p, int32_t x, int32_t y, bool set) {
+    if (x < 0 || y < 0)
+        return;
+    if (set)
+        ssd1306_draw_pixel(p, (uint32_t)x, (uint32_t)y);
+    else
+        ssd1306_clear_pixel(p, (uint32_t)x, (uint32_t)y);
+}
+
+// the driver
+
+static void fast_square(ssd1306_t *p, const args_t *a) { ssd1306_draw_square(p, a->x, a->y, a->a, a->b); }
+static void fast_clear(ssd1306_t *p, const args_t *a) { ssd1306_clear_square(p, a->x, a->y, a->a, a->b); }
+static void fast_empty(ssd1306_t *p, const args_t *a) { ssd1306_draw_empty_square(p, a->x, a->y, a->a, a->b); }
+static void fast_hline(ssd1306_t *p, const args_t *a) { ssd1306_draw_hline(p, a->x - 8, a->y, a->a * 4); }
+static void fast_vline(ssd1306_t *p, const args_t *a) { ssd1306_draw_vline(p, a->x, a->y - 8, a->b * 2); }
+static void fast_image(ssd1306_t *p, const args_t *a) { ssd1306_draw_image(p, a->x, a->y, &tile); }
+static void fast_copy(ssd1306_t *p, const args_t *a) { ssd1306_copy_image(p, a->x, a->y, &tile); }
+static void fast_line(ssd1306_t *p, const args_t *a) { ssd1306_draw_line(p, a->x, a->y, a->a * 4, a->b * 2); }
+// a: scale, b: font
+static void fast_text(ssd1306_t *p, const args_t *a) { ssd1306_draw_string_with_font(p, a->x, a->y, a->a, fonts[a->b], text); }
+
+// a: pfonts index
+static void fast_pfont(ssd1306_t *p, const args_t *a) { ssd1306_draw_string_pfont(p, a->x, a->y, pfonts[a->a].pfont, text); }
+static void legacy_text(ssd1306_t *p, const args_t *a) {
+    ssd1306_draw_string_with_font(p, a->x, a->y, pfonts[a->a].scale, fonts[pfonts[a->a].font], text);
+}
+
+// pixel by pixel
+
+static void rect_pixels(ssd1306_t *p, int32_t x, int32_t y, int32_t w, int32_t h, bool set) {
+    for (int32_t i = 0; i < w; ++i)
+        for (int32_t j = 0; j < h; ++j)
+            pixel_at(p, x + i, y + j, set);
+}
+
+static void slow_square(ssd1306_t *p, const args_t *a) { rect_pixels(p, a->x, a->y, a->a, a->b, true); }
+static void slow_clear(ssd1306_t *p, const args_t *a) { rect_pixels(p, a->x, a->y, a->a, a->b, false); }
+static void slow_hline(ssd1306_t *p, const args_t *a) { rect_pixels(p, a->x - 8, a->y, a->a * 4, 1, true); }
+static void slow_vline(ssd1306_t *p, const args_t *a) { rect_pixels(p, a->x, a->y - 8, 1, a->b * 2, true); }
+
+static void slow_empty(ssd1306_t *p, const args_t *a) {
+    rect_pixels(p, a->x, a->y, a->a + 1, 1, true);
+    rect_pixels(p, a->x, a->y + a->b, a->a + 1, 1, true);
+    rect_pixels(p, a->x, a->y, 1, a->b + 1, true);
+    rect_pixels(p, a->x + a->a, a->y, 1, a->b + 1, true);
+}
+
+static void image_pixels(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_image_t *img, bool copy) {
+    for (int32_t i = 0; i < img->width; ++i)
+        for (int32_t j = 0; j < img->height; ++j) {
+            bool on = img->data[(j >> 3) * img->width + i] >> (j & 7) & 1;
+            if (on || copy)
+                pixel_at(p, x + i, y + j, on);
+        }
+}
+
+static void slow_image(ssd1306_t *p, const args_t *a) { image_pixels(p, a->x, a->y, &tile, false); }
+static void slow_copy(ssd1306_t *p, const args_t *a) { image_pixels(p, a->x, a->y, &tile, true); }
+
+// the line as it was: float slope, one pixel per column, truncated
+static void slow_line(ssd1306_t *p, const args_t *a) {
+    int32_t x1 = a->x, y1 = a->y, x2 = a->a * 4, y2 = a->b * 2;
+    if (x1 > x2) {
+        int32_t t = x1; x1 = x2; x2 = t;
+        t = y1; y1 = y2; y2 = t;
+    }
+    if (x1 == x2) {
+        for (int32_t i = y1 < y2 ? y1 : y2; i <= (y1 < y2 ? y2 : y1); ++i)
+            pixel_at(p, x1, i, true);
+        return;
+    }
+    float m = (float)(y2 - y1) / (float)(x2 - x1);
+    for (int32_t i = x1; i <= x2; ++i)
+        pixel_at(p, i, (int32_t)(m * (float)(i - x1) + (float)y1), true);
+}
+
+// the text as it was: a scale x scale square per font pixel
+static void slow_text(ssd1306_t *p, const args_t *a) {
+    const uint8_t *font = fonts[a->b];
+    int32_t scale = a->a;
+    uint32_t parts_per_line = (font[0] >> 3) + ((font[0] & 7) > 0);
+    int32_t x = a->x;
+    for (const char *c = text; *c; ++c, x += (font[1] + font[2]) * scale) {
+        if (*c < font[3] || *c > font[4] || x >= WIDTH)
+            continue;
+        const uint8_t *glyph = font + 5 + (*c - font[3]) * font[1] * parts_per_line;
+        for (int32_t w = 0; w < font[1]; ++w)
+            for (uint32_t lp = 0; lp < parts_per_line; ++lp)
+                for (int32_t j = 0; j < 8; ++j)
+                    if (glyph[w * parts_per_line + lp] >> j & 1)
+                        rect_pixels(p, x + w * scale, a->y + (int32_t)(lp * 8 + j) * scale, scale, scale, true);
+    }
+}
+
+typedef struct {
+    const char *name;
+    draw_fn fast, slow;
+    bool same;      // pixel-identical to the per-pixel version
+} bench_t;
+
+static const bench_t benches[] = {
+    {"square",       fast_square, slow_square, true},
+    {"clear_square", fast_clear,  slow_clear,  true},
+    {"empty_square", fast_empty,  slow_empty,  true},
+    {"hline",        fast_hline,  slow_hline,  true},
+    {"vline",        fast_vline,  slow_vline,  true},
+    {"draw_image",   fast_image,  slow_image,  true},
+    {"copy_image",   fast_copy,   slow_copy,   true},
+    {"line",         fast_line,   slow_line,   false},
+};
+
+static args_t args[ARGS];
+
+static double ns_per_call(ssd1306_t *p, draw_fn f, uint32_t rounds) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t r = 0; r < rounds; ++r)
+        for (uint32_t i = 0; i < ARGS; ++i)
+            f(p, &args[i]);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)rounds * ARGS);
+}
+
+// both versions on the same random background
+static void compare(ssd1306_t *p, const bench_t *b) {
+    static uint8_t background[WIDTH * HEIGHT / 8], want[WIDTH * HEIGHT / 8];
+    for (uint32_t i = 0; i < ARGS; ++i) {
+        for (uint32_t k = 0; k < sizeof(background); ++k)
+            background[k] = (uint8_t)rnd(256);
+        memcpy(p->buffer, background, p->bufsize);
+        b->slow(p, &args[i]);
+        memcpy(want, p->buffer, p->bufsize);
+        memcpy(p->buffer, background, p->bufsize);
+        b->fast(p, &args[i]);
+        if (memcmp(want, p->buffer, p->bufsize)) {
+            const args_t *a = &args[i];
+            printf("  %s(%d, %d, %d, %d) differs from the per-pixel version\n", b->name, a->x, a->y, a->a, a->b);
+            ++failures;
+            return;
+        }
+    }
+}
+
+static uint32_t lit(const ssd1306_t *p) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < p->bufsize; ++i)
+        n += (uint32_t)__builtin_popcount(p->buffer[i]);
+    return n;
+}
+
+static bool lit_at(const ssd1306_t *p, int32_t x, int32_t y) {
+    return p->buffer[(y >> 3) * p->width + x] >> (y & 7) & 1;
+}
+
+// Bresenham on screen: one pixel per step of the longer axis, both ends, either direction
+static void check_lines(ssd1306_t *p) {
+    static uint8_t first[WIDTH * HEIGHT / 8];
+    for (uint32_t i = 0; i < ARGS; ++i) {
+        int32_t x1 = (int32_t)rnd(WIDTH), y1 = (int32_t)rnd(HEIGHT);
+        int32_t x2 = (int32_t)rnd(WIDTH), y2 = (int32_t)rnd(HEIGHT);
+        int32_t dx = abs(x2 - x1), dy = abs(y2 - y1);
+
+        memset(p->buffer, 0, p->bufsize);
+        ssd1306_draw_line(p, x1, y1, x2, y2);
+        memcpy(first, p->buffer, p->bufsize);
+        bool ok = lit(p) == (uint32_t)(dx > dy ? dx : dy) + 1 && lit_at(p, x1, y1) && lit_at(p, x2, y2);
+
+        memset(p->buffer, 0, p->bufsize);
+        ssd1306_draw_line(p, x2, y2, x1, y1);
+        ok = ok && !memcmp(first, p->buffer, p->bufsize);
+        if (!ok) {
+            printf("  line (%d, %d)-(%d, %d) is not a Bresenham line\n", x1, y1, x2, y2);
+            ++failures;
+            return;
+        }
+    }
+}
+
+// every pfont against the font it was made from, random printable strings on a random background
+static void check_pfonts(ssd1306_t *p) {
+    static uint8_t background[WIDTH * HEIGHT / 8], want[WIDTH * HEIGHT / 8];
+    const char *saved = text;
+    char s[13];
+    text = s;
+    for (size_t f = 0; f < count_of(pfonts); ++f) {
+        for (uint32_t i = 0; i < ARGS / 4; ++i) {
+            size_t len = 1 + rnd(sizeof(s) - 1);
+            for (size_t k = 0; k < len; ++k)
+                s[k] = (char)(' ' + rnd(95));
+            s[len] = '\0';
+            args_t a = {(int32_t)rnd(WIDTH + 8), (int32_t)rnd(HEIGHT + 8), (int32_t)f, 0};
+            for (uint32_t k = 0; k < sizeof(background); ++k)
+                background[k] = (uint8_t)rnd(256);
+            memcpy(p->buffer, background, p->bufsize);
+            legacy_text(p, &a);
+            memcpy(want, p->buffer, p->bufsize);
+            memcpy(p->buffer, background, p->bufsize);
+            fast_pfont(p, &a);
+            if (memcmp(want, p->buffer, p->bufsize)) {
+                printf("  %s: \"%s\" at (%d, %d) differs from ssd1306_draw_string_with_font\n", pfonts[f].name, s,
+                       a.x, a.y);
+                ++failures;
+                break;
+            }
+        }
+    }
+    text = saved;
+}
+
+typedef struct {
+    const char *name;
+    const ssd1306_image_t *img;
+    const uint8_t *bmp;
+    long size;
+} bmp_case_t;
+
+#define BMP_CASE(n) {#n, &n, n##_bmp, sizeof(n##_bmp)}
+
+static const bmp_case_t bmps[] = {
+    {"image.h", &splash_image, image_data, sizeof(image_data)},
+    BMP_CASE(bottom_up_13x11), BMP_CASE(top_down_20x9), BMP_CASE(black_at_1_9x17),
+    BMP_CASE(top_down_black_at_1_40x3),
+};
+
+static void check_bmps(ssd1306_t *p) {
+    static uint8_t background[WIDTH * HEIGHT / 8], want[WIDTH * HEIGHT / 8];
+    for (size_t b = 0; b < count_of(bmps); ++b) {
+        const bmp_case_t *c = &bmps[b];
+        for (uint32_t x = 0; x <= WIDTH; x += 3)
+            for (uint32_t y = 0; y <= HEIGHT; ++y) {
+                for (uint32_t k = 0; k < sizeof(background); ++k)
+                    background[k] = (uint8_t)rnd(256);
+                memcpy(p->buffer, background, p->bufsize);
+                ssd1306_bmp_show_image_with_offset(p, c->bmp, c->size, x, y);
+                memcpy(want, p->buffer, p->bufsize);
+                memcpy(p->buffer, background, p->bufsize);
+                ssd1306_draw_image(p, x, y, c->img);
+                if (memcmp(want, p->buffer, p->bufsize)) {
+                    printf("  %s at (%u, %u) differs from ssd1306_bmp_show_image_with_offset\n", c->name, x, y);
+                    ++failures;
+                    x = WIDTH;
+                    break;
+                }
+            }
+    }
+}
+
+// cycles per string: the host ns per call of one string
+static void time_text(ssd1306_t *p, int32_t font, int32_t scale, uint32_t rounds) {
+    int32_t h = fonts[font][0] * scale;
+    for (uint32_t i = 0; i < ARGS; ++i)
+        args[i] = (args_t){(int32_t)rnd(16), (int32_t)rnd(h < HEIGHT ? HEIGHT - h + 1 : 1), scale, font};
+    // a whole string per call, so fewer rounds
+    double fast = ns_per_call(p, fast_text, rounds / 10 + 1);
+    double slow = ns_per_call(p, slow_text, rounds / 10 + 1);
+    char name[48];
+    snprintf(name, sizeof(name), "\"%s\" %s x%d", text, font_names[font], scale);
+    printf("%-40s %10.1f %10.1f %7.1fx\n", name, fast, slow, slow / fast);
+}
+
+int main(int argc, char **argv) {
+    uint32_t rounds = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 50;
+
+    static int bus_token;
+    i2c_inst_t *bus = (i2c_inst_t *)&bus_token;
+    static ssd1306_emu_t emu;
+    ssd1306_emu_reset(&emu);
+    i2c_async_init(bus, NULL, 0);
+    i2c_async_host_attach(bus, ADDR, &emu);
+    ssd1306_t disp = {.external_vcc = false};
+    if (!ssd1306_init(&disp, WIDTH, HEIGHT, ADDR, bus)) {
+        fprintf(stderr, "ssd1306_init failed\n");
+        return 1;
+    }
+
+    // the square API takes unsigned coordinates, so only the right and bottom edges clip;
+    // lines, hline and vline also start left of and above the screen
+    for (uint32_t i = 0; i < ARGS; ++i)
+        args[i] = (args_t){(int32_t)rnd(WIDTH + 8), (int32_t)rnd(HEIGHT + 8), (int32_t)rnd(40), (int32_t)rnd(40)};
+
+    printf("%-40s %10s %10s %8s\n", "", "ns/call", "per-pixel", "speedup");
+    for (size_t b = 0; b < count_of(benches); ++b) {
+        const bench_t *bench = &benches[b];
+        if (bench->same)
+            compare(&disp, bench);
+        double fast = ns_per_call(&disp, bench->fast, rounds);
+        double slow = ns_per_call(&disp, bench->slow, rounds);
+        printf("%-40s %10.1f %10.1f %7.1fx\n", bench->name, fast, slow, slow / fast);
+    }
+    check_lines(&disp);
+    check_bmps(&disp);
+
+    // text: every font and scale 1..5 must match
+    static const bench_t text_bench = {"text", fast_text, slow_text, true};
+    for (uint32_t i = 0; i < ARGS; ++i)
+        args[i] = (args_t){(int32_t)rnd(WIDTH + 8), (int32_t)rnd(HEIGHT + 8), 1 + (int32_t)rnd(5),
+                           (int32_t)rnd(count_of(fonts))};
+    compare(&disp, &text_bench);
+
+    // timed per string with the builtin font and the one of the frequency display
+    static const int32_t timed[] = {0, 3};
+    for (size_t f = 0; f < count_of(timed); ++f)
+        for (int32_t scale = 1; scale <= 4; ++scale)
+            time_text(&disp, timed[f], scale, rounds);
+    text = "145000000";
+    for (size_t f = 0; f < count_of(timed); ++f)
+        time_text(&disp, timed[f], 2, rounds);
+
+    // page-aligned fonts: all must match, the frequency display font timed against the column blitter
+    check_pfonts(&disp);
+    printf("%-40s %10s %10s %8s\n", "", "pfont", "blitter", "speedup");
+    for (size_t f = 0; f < count_of(pfonts); ++f) {
+        if (pfonts[f].font != 3)
+            continue;
+        int32_t h = pfonts[f].pfont->height;
+        for (uint32_t i = 0; i < ARGS; ++i)
+            args[i] = (args_t){(int32_t)rnd(16), (int32_t)rnd(HEIGHT - h + 1), (int32_t)f, 0};
+        double fast = ns_per_call(&disp, fast_pfont, rounds / 10 + 1);
+        double slow = ns_per_call(&disp, legacy_text, rounds / 10 + 1);
+        char name[48];
+        snprintf(name, sizeof(name), "\"%s\" %s", text, pfonts[f].name);
+        printf("%-40s %10.1f %10.1f %7.1fx\n", name, fast, slow, slow / fast);
+    }
+
+    ssd1306_deinit(&disp);
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "ssd1306_emu.h"
+#include "i2c_async_host.h"
+
+/*
+ * Command lists of ssd1306.c on the emulated I2C bus: every command sequence
+ * must go out as one transaction, and the emulator must decode it. Prints the
+ * bus cost next to what one transaction per command byte (address, control
+ * byte, command) used to take.
+ */
+
+#define WIDTH  128
+#define HEIGHT 64
+#define ADDR   0x3C
+#define I2C_HZ 400000
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            ++failures; \
+        } \
+    } while (0)
+
+static int bus_token;
+static i2c_inst_t *const bus = (i2c_inst_t *)&bus_token;
+static ssd1306_emu_t emu;
+
+static void start(void) {
+    i2c_async_reset_stats(bus);
+    emu.cmd_bytes = 0;
+    emu.data_bytes = 0;
+}
+
+// transactions and bytes since start(), the address byte of every transaction included
+static void measure(const char *name, uint32_t want_txn, uint32_t want_bytes) {
+    i2c_async_client_stats_t st;
+    i2c_async_get_stats(bus, 0, &st);
+    uint32_t bytes = st.bytes + st.transactions;
+    uint32_t per_byte = 3 * emu.cmd_bytes;
+    printf("%-14s %2u transactions %4u bytes %5u us, one per command byte %2u / %3u bytes %5u us\n", name,
+           st.transactions, bytes, bytes * 9 * 1000000u / I2C_HZ,
+           emu.cmd_bytes, per_byte, per_byte * 9 * 1000000u / I2C_HZ);
+    CHECK(st.transactions == want_txn && bytes == want_bytes, "%s: %u transactions %u bytes, want %u / %u",
+          name, st.transactions, bytes, want_txn, want_bytes);
+    CHECK(st.errors == 0, "%s: %u errors", name, st.errors);
+}
+
+int main(void) {
+    ssd1306_emu_reset(&emu);
+    i2c_async_init(bus, NULL, 0);
+    i2c_async_host_attach(bus, ADDR, &emu);
+
+    ssd1306_t disp = {.external_vcc = false};
+    start();
+    CHECK(ssd1306_init(&disp, WIDTH, HEIGHT, ADDR, bus), "ssd1306_init");
+    measure("init", 1, 27);
+    CHECK(emu.cmd_bytes == 25 && emu.on && emu.seg_remap && emu.com_remap && emu.mode == 0 && emu.contrast == 0xFF,
+          "init decoded wrong");
+
+    start();
+    ssd1306_contrast(&disp, 0x42);
+    measure("contrast", 1, 4);
+    CHECK(emu.contrast == 0x42, "contrast 0x%02x", emu.contrast);
+
+    start();
+    ssd1306_invert(&disp, 1);
+    measure("invert", 1, 3);
+    CHECK(emu.invert, "not inverted");
+    ssd1306_invert(&disp, 0);
+
+    start();
+    ssd1306_poweroff(&disp);
+    measure("poweroff", 1, 3);
+    CHECK(!emu.on, "still on");
+    ssd1306_poweron(&disp);
+
+    // one window: the column/page header is one list, the data a second transaction
+    ssd1306_clear(&disp);
+    ssd1306_show(&disp);
+    ssd1306_draw_pixel(&disp, 70, 20);
+    start();
+    ssd1306_show(&disp);
+    measure("window", 2, 8 + 3);
+    CHECK(emu.ram[2][70] == 0x10, "pixel not in GDDRAM");
+
+    // a caller-built list, and lists that must not be sent
+    uint8_t storage[6];
+    ssd1306_cmdlist_t l;
+    ssd1306_cmdlist_init(&l, storage, sizeof(storage));
+    ssd1306_cmdlist_add(&l, SET_CONTRAST);
+    ssd1306_cmdlist_add(&l, 0x10);
+    ssd1306_cmdlist_add(&l, SET_NORM_INV | 1);
+    start();
+    CHECK(ssd1306_cmdlist_send(&disp, &l), "cmdlist_send");
+    measure("cmdlist", 1, 5);
+    CHECK(emu.contrast == 0x10 && emu.invert, "list decoded wrong");
+
+    const uint8_t more[] = {SET_DISP, SET_DISP | 1, SET_ENTIRE_ON};
+    ssd1306_cmdlist_add_n(&l, more, sizeof(more));
+    CHECK(l.overflow && l.len == sizeof(storage), "overflow not flagged, len %zu", l.len);
+    ssd1306_cmdlist_t empty;
+    ssd1306_cmdlist_init(&empty, storage, sizeof(storage));
+    start();
+    CHECK(!ssd1306_cmdlist_send(&disp, &l), "overflowed list sent");
+    CHECK(!ssd1306_cmdlist_send(&disp, &empty), "empty list sent");
+    measure("not sent", 0, 0);
+
+    ssd1306_deinit(&disp);
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssd1306_emu.h"
+
+void ssd1306_emu_reset(ssd1306_emu_t *e) {
+    memset(e, 0, sizeof(*e));
+    e->mode = 2;
+    e->col_hi = SSD1306_EMU_COLS - 1;
+    e->page_hi = SSD1306_EMU_PAGES - 1;
+    e->contrast = 0x7F;
+    e->mux = 63;
+}
+
+// argument bytes following the command byte
+static uint8_t cmd_args(uint8_t c) {
+    switch (c) {
+    case 0x81: // contrast
+    case 0x20: // memory addressing mode
+    case 0xA8: // multiplex ratio
+    case 0xD3: // display offset
+    case 0xDA: // COM pins
+    case 0xD5: // clock divide
+    case 0xD9: // precharge
+    case 0xDB: // VCOMH deselect
+    case 0x8D: // charge pump
+        return 1;
+    case 0x21: // column window
+    case 0x22: // page window
+    case 0xA3: // vertical scroll area
+        return 2;
+    case 0x29: // vertical and horizontal scroll
+    case 0x2A:
+        return 5;
+    case 0x26: // horizontal scroll
+    case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+static void exec(ssd1306_emu_t *e) {
+    const uint8_t *c = e->cmd;
+
+    switch (c[0]) {
+    case 0x81: e->contrast = c[1]; return;
+    case 0x20: e->mode = c[1] & 3; return;
+    case 0x21:
+        e->col_lo = c[1] & 0x7F;
+        e->col_hi = c[2] & 0x7F;
+        e->col = e->col_lo;
+        return;
+    case 0x22:
+        e->page_lo = c[1] & 7;
+        e->page_hi = c[2] & 7;
+        e->page = e->page_lo;
+        return;
+    case 0xA8: e->mux = c[1] & 0x3F; return;
+    case 0xD3: e->offset = c[1] & 0x3F; return;
+    case 0xA0: case 0xA1: e->seg_remap = c[0] & 1; return;
+    case 0xA4: case 0xA5: e->entire_on = c[0] & 1; return;
+    case 0xA6: case 0xA7: e->invert = c[0] & 1; return;
+    case 0xAE: case 0xAF: e->on = c[0] & 1; return;
+    case 0xC0: case 0xC8: e->com_remap = c[0] & 8; return;
+    case 0xDA: case 0xD5: case 0xD9: case 0xDB: case 0x8D:
+    case 0xA3: case 0x26: case 0x27: case 0x29: case 0x2A:
+    case 0x2E: case 0x2F: case 0xE3:
+        return; // timing, scrolling and NOP: no effect on the image
+    }
+
+    if (c[0] < 0x10) {
+        e->page_mode_col = (e->page_mode_col & 0xF0) | c[0];
+        if (e->mode == 2)
+            e->col = e->page_mode_col;
+    } else if (c[0] < 0x20) {
+        e->page_mode_col = (uint8_t)(((c[0] & 7) << 4) | (e->page_mode_col & 0x0F));
+        if (e->mode == 2)
+            e->col = e->page_mode_col;
+    } else if (c[0] >= 0x40 && c[0] < 0x80) {
+        e->start_line = c[0] & 0x3F;
+    } else if (c[0] >= 0xB0 && c[0] < 0xB8) {
+        if (e->mode == 2)
+            e->page = c[0] & 7;
+    } else {
+        ++e->unknown_cmds;
+    }
+}
+
+void ssd1306_emu_command(ssd1306_emu_t *e, uint8_t b) {
+    ++e->cmd_bytes;
+    if (e->cmd_len == 0)
+        e->cmd_need = cmd_args(b);
+    e->cmd[e->cmd_len++] = b;
+    if (e->cmd_len > e->cmd_need) {
+        exec(e);
+        e->cmd_len = 0;
+    }
+}
+
+void ssd1306_emu_data(ssd1306_emu_t *e, const uint8_t *b, size_t n) {
+    e->data_bytes += n;
+    for (size_t i = 0; i < n; ++i) {
+        e->ram[e->page][e->col] = b[i];
+
+        switch (e->mode) {
+        case 0: // horizontal: columns of the window, then the next page
+            if (e->col++ >= e->col_hi) {
+                e->col = e->col_lo;
+                e->page = e->page >= e->page_hi ? e->page_lo : e->page + 1;
+            }
+            break;
+        case 1: // vertical: pages of the window, then the next column
+            if (e->page++ >= e->page_hi) {
+                e->page = e->page_lo;
+                e->col = e->col >= e->col_hi ? e->col_lo : e->col + 1;
+            }
+            break;
+        default: // page: wraps inside the page
+            if (++e->col >= SSD1306_EMU_COLS)
+                e->col = e->page_mode_col;
+            break;
+        }
+    }
+}
+
+void ssd1306_emu_i2c_write(ssd1306_emu_t *e, const uint8_t *b, size_t n) {
+    while (n > 1) {
+        uint8_t ctrl = b[0];
+        bool is_data = ctrl & 0x40;
+
+        if (!(ctrl & 0x80)) {
+            // Co=0: every remaining byte has the same D/C#
+            if (is_data)
+                ssd1306_emu_data(e, b + 1, n - 1);
+            else
+                for (size_t i = 1; i < n; ++i)
+                    ssd1306_emu_command(e, b[i]);
+            return;
+        }
+
+        // Co=1: one byte, then another control byte
+        if (is_data)
+            ssd1306_emu_data(e, b + 1, 1);
+        else
+            ssd1306_emu_command(e, b[1]);
+        b += 2;
+        n -= 2;
+    }
+}
+
+void ssd1306_emu_render(const ssd1306_emu_t *e, uint32_t width, uint32_t height, uint8_t *gray) {
+    // narrower panels sit in the middle of the 128 segments (see ssd1306_add_window)
+    uint32_t off = (SSD1306_EMU_COLS - width) / 2;
+
+    for (uint32_t y = 0; y < height; ++y) {
+        uint32_t row = e->com_remap ? y : height - 1 - y;
+        row = (row + e->start_line + e->offset) & 63;
+
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t col = off + (e->seg_remap ? x : width - 1 - x);
+            bool lit = (e->ram[row >> 3][col] >> (row & 7)) & 1;
+
+            if (e->entire_on)
+                lit = true;
+            if (e->invert)
+                lit = !lit;
+            if (!e->on || y > e->mux)
+                lit = false;
+            gray[y * width + x] = lit ? 255 : 0;
+        }
+    }
+}
+
+bool ssd1306_emu_write_pgm(const ssd1306_emu_t *e, uint32_t width, uint32_t height, uint32_t scale, const char *path) {
+    uint8_t *gray = malloc(width * height);
+    FILE *f = fopen(path, "wb");
+    if (!gray || !f) {
+        free(gray);
+        if (f)
+            fclose(f);
+        return false;
+    }
+
+    ssd1306_emu_render(e, width, height, gray);
+    fprintf(f, "P5\n%u %u\n255\n", width * scale, height * scale);
+    for (uint32_t y = 0; y < height * scale; ++y)
+        for (uint32_t x = 0; x < width * scale; ++x)
+            fputc(gray[(y / scale) * width + x / scale], f);
+
+    free(gray);
+    return fclose(f) == 0;
+}
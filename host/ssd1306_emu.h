@@ -0,0 +1,63 @@
+#ifndef SSD1306_EMU_H
+#define SSD1306_EMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SSD1306_EMU_COLS  128
+#define SSD1306_EMU_PAGES 8
+
+/*
+ * SSD1306 controller model for host builds: decodes the command/data stream
+ * (horizontal, vertical and page addressing, column/page windows, remap and
+ * display state) into an emulated GDDRAM. Fed by a fake transport, e.g.
+ * i2c_async_host.c for the I2C control-byte framing.
+ */
+typedef struct {
+    uint8_t ram[SSD1306_EMU_PAGES][SSD1306_EMU_COLS];
+
+    uint8_t mode;           // 0 horizontal, 1 vertical, 2 page
+    uint8_t col_lo, col_hi; // SET_COL_ADDR window
+    uint8_t page_lo, page_hi;
+    uint8_t col, page;      // address pointer
+    uint8_t page_mode_col;  // column start of page addressing (0x00-0x1F)
+
+    bool on;
+    bool invert;
+    bool entire_on;
+    bool seg_remap;
+    bool com_remap;
+    uint8_t contrast;
+    uint8_t start_line;
+    uint8_t mux;            // multiplex ratio - 1
+    uint8_t offset;
+
+    uint8_t cmd[8];         // command being assembled across bytes
+    uint8_t cmd_len;
+    uint8_t cmd_need;
+
+    uint32_t unknown_cmds;  // bytes that are no SSD1306 command
+    uint32_t cmd_bytes;
+    uint32_t data_bytes;
+} ssd1306_emu_t;
+
+// Power-on reset state
+void ssd1306_emu_reset(ssd1306_emu_t *e);
+
+// One byte with D/C# low
+void ssd1306_emu_command(ssd1306_emu_t *e, uint8_t b);
+
+// Bytes with D/C# high, written at the address pointer
+void ssd1306_emu_data(ssd1306_emu_t *e, const uint8_t *b, size_t n);
+
+// Payload of one I2C write (address byte excluded): control bytes select command or data
+void ssd1306_emu_i2c_write(ssd1306_emu_t *e, const uint8_t *b, size_t n);
+
+// Panel image as the viewer sees it, width x height bytes of 0 or 255
+void ssd1306_emu_render(const ssd1306_emu_t *e, uint32_t width, uint32_t height, uint8_t *gray);
+
+// Binary PGM of the panel, every pixel scale x scale
+bool ssd1306_emu_write_pgm(const ssd1306_emu_t *e, uint32_t width, uint32_t height, uint32_t scale, const char *path);
+
+#endif
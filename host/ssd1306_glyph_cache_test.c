@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "ssd1306_emu.h"
+#include "i2c_async_host.h"
+
+#include "BMSPA_font.h"
+#include "bubblesstandard_font.h"
+
+/*
+ * The glyph cache of ssd1306.c, built with SSD1306_GLYPH_CACHE_BYTES=1024:
+ * text drawn through the cache must leave the same frame buffer as the same
+ * text drawn from the font, and the counters must count what was drawn.
+ * The uncached reference uses a copy of the font in RAM, which the cache does
+ * not know, so it must not move the counters either.
+ */
+
+#define WIDTH  128
+#define HEIGHT 64
+#define ADDR   0x3C
+#define DIGITS "0123456789"
+
+#if SSD1306_GLYPH_CACHE_BYTES != 1024
+#error build with -DSSD1306_GLYPH_CACHE_BYTES=1024
+#endif
+
+extern const uint8_t font_8x5[];    // defined in ssd1306.c through font.h
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            ++failures; \
+        } \
+    } while (0)
+
+static uint32_t rng = 2463534242u;
+static uint32_t rnd(uint32_t n) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+static ssd1306_t disp = {.external_vcc = false};
+
+static ssd1306_glyph_cache_stats_t stats(void) {
+    ssd1306_glyph_cache_stats_t st;
+    ssd1306_glyph_cache_get_stats(&st);
+    return st;
+}
+
+static void check_stats(const char *name, uint32_t hits, uint32_t misses, uint32_t fills) {
+    ssd1306_glyph_cache_stats_t st = stats();
+    CHECK(st.hits == hits && st.misses == misses && st.fills == fills,
+          "%s: hits %u misses %u fills %u, want %u / %u / %u", name, st.hits, st.misses, st.fills, hits, misses, fills);
+}
+
+// random strings of chars at random (also clipped, unaligned) places, through the cache and from the font
+static void check_same(const char *name, const uint8_t *font, uint32_t scale, const char *chars) {
+    static uint8_t copy[5 + 95 * 8], background[WIDTH * HEIGHT / 8], want[WIDTH * HEIGHT / 8];
+    memcpy(copy, font, 5 + (size_t)(font[4] - font[3] + 1) * font[1] * ((font[0] + 7) / 8));
+
+    char s[12];
+    for (int i = 0; i < 1000; ++i) {
+        size_t len = 1 + rnd(sizeof(s) - 1);
+        for (size_t k = 0; k < len; ++k)
+            s[k] = chars[rnd((uint32_t)strlen(chars))];
+        s[len] = '\0';
+        uint32_t x = rnd(WIDTH + 8), y = rnd(HEIGHT + 8);
+        for (size_t k = 0; k < sizeof(background); ++k)
+            background[k] = (uint8_t)rnd(256);
+
+        memcpy(disp.buffer, background, disp.bufsize);
+        ssd1306_glyph_cache_stats_t before = stats();
+        ssd1306_draw_string_with_font(&disp, x, y, scale, copy, s);
+        ssd1306_glyph_cache_stats_t after = stats();
+        memcpy(want, disp.buffer, disp.bufsize);
+
+        memcpy(disp.buffer, background, disp.bufsize);
+        ssd1306_draw_string_with_font(&disp, x, y, scale, font, s);
+        if (memcmp(want, disp.buffer, disp.bufsize)) {
+            printf("  %s: \"%s\" at (%u, %u) differs from the uncached glyphs\n", name, s, x, y);
+            ++failures;
+            return;
+        }
+        if (memcmp(&before, &after, sizeof(before))) {
+            printf("  %s: a font the cache does not hold moved the counters\n", name);
+            ++failures;
+            return;
+        }
+    }
+    printf("%-32s same as uncached\n", name);
+}
+
+int main(void) {
+    static int bus_token;
+    i2c_inst_t *bus = (i2c_inst_t *)&bus_token;
+    static ssd1306_emu_t emu;
+    ssd1306_emu_reset(&emu);
+    i2c_async_init(bus, NULL, 0);
+    i2c_async_host_attach(bus, ADDR, &emu);
+    if (!ssd1306_init(&disp, WIDTH, HEIGHT, ADDR, bus)) {
+        fprintf(stderr, "ssd1306_init failed\n");
+        return 1;
+    }
+
+    // the frequency digits: filled on first use, every later digit a hit
+    CHECK(ssd1306_glyph_cache_config(bubblesstandard_font, 2, DIGITS, false), "digits do not fit");
+    check_stats("configured", 0, 0, 0);
+    ssd1306_draw_string_with_font(&disp, 5, 35, 2, bubblesstandard_font, "014250000");
+    check_stats("first string", 4, 5, 5);               // 0 1 4 2 5 rendered, then four 0s
+    ssd1306_draw_string_with_font(&disp, 5, 35, 2, bubblesstandard_font, "014250000");
+    check_stats("same string", 13, 5, 5);
+    ssd1306_draw_string_with_font(&disp, 5, 35, 2, bubblesstandard_font, "9 Hz");
+    check_stats("chars outside the set", 13, 9, 6);     // 9 rendered; ' ', 'H', 'z' drawn from the font
+    ssd1306_draw_string_with_font(&disp, 5, 35, 1, bubblesstandard_font, "0123");
+    ssd1306_draw_string_with_font(&disp, 5, 35, 2, font_8x5, "0123");
+    check_stats("other scale or font", 13, 9, 6);
+    check_same("bubblesstandard x2, digits", bubblesstandard_font, 2, DIGITS " Hz.");
+
+    // prefill renders the set at once and starts the counters from there
+    CHECK(ssd1306_glyph_cache_config(bubblesstandard_font, 2, DIGITS DIGITS, true), "digits do not fit");
+    check_stats("prefill", 0, 0, 10);
+    ssd1306_draw_string_with_font(&disp, 0, 0, 2, bubblesstandard_font, "7");
+    check_stats("after prefill", 1, 0, 10);
+
+    // the budget: 1024 / (8 * 7 columns) = 18 glyphs, the rest is drawn uncached
+    const char *letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    CHECK(!ssd1306_glyph_cache_config(bubblesstandard_font, 3, letters, true), "26 glyphs fit 1024 bytes");
+    check_stats("over budget", 0, 0, 18);
+    ssd1306_draw_string_with_font(&disp, 0, 0, 3, bubblesstandard_font, "AZ");
+    check_stats("over budget, drawn", 1, 1, 18);
+    check_same("bubblesstandard x3, over budget", bubblesstandard_font, 3, letters);
+
+    // other fonts and scales, and glyphs that end below the last page
+    CHECK(ssd1306_glyph_cache_config(font_8x5, 1, DIGITS "ABC", false), "font_8x5 x1");
+    check_same("font_8x5 x1", font_8x5, 1, DIGITS "ABCxyz");
+    CHECK(ssd1306_glyph_cache_config(BMSPA_font, 4, DIGITS, false), "BMSPA x4");
+    check_same("BMSPA x4", BMSPA_font, 4, DIGITS "-");
+
+    // off again: nothing is cached or counted
+    CHECK(ssd1306_glyph_cache_config(NULL, 0, NULL, false), "off");
+    ssd1306_draw_string_with_font(&disp, 5, 35, 2, bubblesstandard_font, "014250000");
+    check_stats("off", 0, 0, 0);
+
+    ssd1306_deinit(&disp);
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
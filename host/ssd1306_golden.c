@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "ui_screen.h"
+#include "ssd1306_emu.h"
+#include "i2c_async_host.h"
+#include "spi_host.h"
+
+/*
+ * Renders a sequence of frequency screens, then drawing primitives (lines in
+ * every octant, shapes clipped at the edges, images at unaligned positions),
+ * through the real driver into the emulator and compares every frame with
+ * golden/<name>.pgm. The same frames
+ * also go to a second display over SPI, whose GDDRAM must end up identical,
+ * and to a third one that is sent in full every frame: the dirty spans of
+ * the first must leave the same GDDRAM as a full ssd1306_show(). Random
+ * primitives then check the dirty spans the same way, frame by frame.
+ *
+ *   ssd1306_golden [-u] [-d DIR] [-g GOLDEN_DIR]
+ *     -u  rewrite the golden images instead of comparing
+ *     -d  also dump every frame, 4x enlarged, into DIR
+ *
+ * Prints transactions and bytes per frame for both buses; exits 1 on any mismatch.
+ */
+
+#define WIDTH  128
+#define HEIGHT 64
+#define ADDR   0x3C
+#define NUM_DIGITS 9
+#define SPI_DC  20
+#define SPI_CS  21
+#define SPI_RST 22
+
+// lines from the centre of a star to 16 points around it: every octant, both axes and diagonals
+static void draw_star(ssd1306_t *p, int32_t cx, int32_t cy, bool inward) {
+    static const int8_t ends[][2] = {
+        {28, 0}, {28, 11}, {20, 20}, {11, 28}, {0, 28}, {-11, 28}, {-20, 20}, {-28, 11},
+        {-28, 0}, {-28, -11}, {-20, -20}, {-11, -28}, {0, -28}, {11, -28}, {20, -20}, {28, -11},
+    };
+    for (size_t i = 0; i < count_of(ends); ++i) {
+        int32_t x = cx + ends[i][0], y = cy + ends[i][1] * 7 / 8;
+        if (inward)
+            ssd1306_draw_line(p, x, y, cx, cy);
+        else
+            ssd1306_draw_line(p, cx, cy, x, y);
+    }
+}
+
+// left star drawn outwards, right star inwards: the same pixels either way
+static void draw_lines_octants(ssd1306_t *p) {
+    draw_star(p, 32, 32, false);
+    draw_star(p, 96, 32, true);
+}
+
+static void draw_clip_edges(ssd1306_t *p) {
+    ssd1306_draw_square(p, 118, 57, 20, 20);
+    ssd1306_draw_empty_square(p, 100, 40, 40, 40);
+    ssd1306_draw_hline(p, -5, 3, 20);
+    ssd1306_draw_vline(p, 127, -4, 14);
+    ssd1306_draw_hline(p, 110, 63, 30);
+    ssd1306_draw_line(p, -10, -5, 20, 40);
+    ssd1306_draw_line(p, 90, 70, 140, 20);
+    ssd1306_draw_line(p, 60, -20, 40, 80);
+    // a hole across a page boundary, then text cut by the right edge
+    ssd1306_draw_square(p, 30, 20, 40, 30);
+    ssd1306_clear_square(p, 35, 13, 20, 20);
+    ssd1306_draw_string(p, 100, 0, 2, "CLIP");
+}
+
+// 13 x 11, two pages: a border and a diagonal
+static const uint8_t tile_data[] = {
+    0xFF, 0x03, 0x05, 0x09, 0x11, 0x21, 0x41, 0x81, 0x01, 0x01, 0x01, 0x01, 0xFF,
+    0x07, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x05, 0x06, 0x04, 0x04, 0x07,
+};
+static const ssd1306_image_t tile = {.width = 13, .height = 11, .data = tile_data};
+
+static void draw_image_unaligned(ssd1306_t *p) {
+    for (uint32_t i = 0; i < 8; ++i)
+        ssd1306_draw_image(p, 2 + 15 * i, i, &tile);     // every shift inside a page
+    ssd1306_draw_square(p, 0, 24, 128, 16);
+    for (uint32_t i = 0; i < 8; ++i)
+        ssd1306_copy_image(p, 2 + 15 * i, 21 + i, &tile); // clear pixels replace the background
+    ssd1306_copy_image(p, 40, 48, &tile);                // aligned, partial last page
+    ssd1306_draw_image(p, 120, 58, &tile);               // clipped right and bottom
+    ssd1306_copy_image(p, 100, 53, &tile);
+}
+
+typedef struct {
+    const char *name;
+    const char *digits;
+    int selected;
+    bool editing;
+    void (*draw)(ssd1306_t *p);     // drawn on a cleared buffer instead of the frequency screen
+} scene_t;
+
+// in this order, so every frame after the first is an incremental update
+static const scene_t scenes[] = {
+    {"freq_idle",        "000000000", 0, false},
+    {"freq_cursor3",     "000000000", 3, false},
+    {"freq_edit3",       "000000000", 3, true},
+    {"freq_edit3_value", "000100000", 3, true},
+    {"freq_14mhz",       "014250000", 8, false},
+    {"freq_max",         "160000000", 0, true},
+    {"lines_octants",    NULL, 0, false, draw_lines_octants},
+    {"clip_edges",       NULL, 0, false, draw_clip_edges},
+    {"image_unaligned",  NULL, 0, false, draw_image_unaligned},
+};
+
+static void draw_scene(ssd1306_t *p, const scene_t *sc) {
+    if (sc->draw) {
+        ssd1306_clear(p);
+        sc->draw(p);
+        return;
+    }
+    int digits[NUM_DIGITS];
+    for (int i = 0; i < NUM_DIGITS; ++i)
+        digits[i] = sc->digits[i] - '0';
+    ui_draw_frequency(p, digits, NUM_DIGITS, sc->selected, sc->editing);
+}
+
+static uint32_t rng = 2463534242u;
+static uint32_t rnd(uint32_t n) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+typedef struct {
+    int kind;
+    int32_t x, y, a, b;
+} draw_op_t;
+
+enum { OP_PIXEL, OP_UNPIXEL, OP_SQUARE, OP_UNSQUARE, OP_EMPTY, OP_LINE, OP_STRING, OP_CLEAR, OP_KINDS };
+
+static draw_op_t random_op(void) {
+    // coordinates reach past every edge, so the clipped spans are marked too
+    draw_op_t o = {.kind = (int)rnd(OP_KINDS), .x = (int32_t)rnd(WIDTH + 16) - 8, .y = (int32_t)rnd(HEIGHT + 16) - 8,
+                   .a = (int32_t)rnd(WIDTH + 16) - 8, .b = (int32_t)rnd(HEIGHT + 16) - 8};
+    if (o.kind == OP_CLEAR && rnd(8))
+        o.kind = OP_PIXEL;  // keep most frames incremental
+    return o;
+}
+
+static void draw_op(ssd1306_t *p, const draw_op_t *o) {
+    uint32_t ux = (uint32_t)o->x, uy = (uint32_t)o->y;
+    uint32_t w = (uint32_t)(o->a & 31), h = (uint32_t)(o->b & 31);
+    switch (o->kind) {
+    case OP_PIXEL:    ssd1306_draw_pixel(p, ux, uy); break;
+    case OP_UNPIXEL:  ssd1306_clear_pixel(p, ux, uy); break;
+    case OP_SQUARE:   ssd1306_draw_square(p, ux, uy, w, h); break;
+    case OP_UNSQUARE: ssd1306_clear_square(p, ux, uy, w, h); break;
+    case OP_EMPTY:    ssd1306_draw_empty_square(p, ux, uy, w, h); break;
+    case OP_LINE:     ssd1306_draw_line(p, o->x, o->y, o->a, o->b); break;
+    case OP_STRING:   ssd1306_draw_string(p, ux, uy, 1 + (o->a & 1), "42 MHz"); break;
+    case OP_CLEAR:    ssd1306_clear(p); break;
+    }
+}
+
+static bool same_ram(const ssd1306_emu_t *a, const ssd1306_emu_t *b) {
+    return !memcmp(a->ram, b->ram, sizeof(a->ram));
+}
+
+// the same random drawing, flushed as dirty spans on inc and in full on full
+static int check_random_spans(ssd1306_t *inc, const ssd1306_emu_t *ei, i2c_inst_t *bus_inc,
+                              ssd1306_t *full, const ssd1306_emu_t *ef, i2c_inst_t *bus_full, uint32_t frames) {
+    i2c_async_reset_stats(bus_inc);
+    i2c_async_reset_stats(bus_full);
+    for (uint32_t f = 0; f < frames; ++f) {
+        for (uint32_t n = 1 + rnd(4); n; --n) {
+            draw_op_t o = random_op();
+            draw_op(inc, &o);
+            draw_op(full, &o);
+        }
+        ssd1306_show(inc);
+        ssd1306_invalidate(full);
+        ssd1306_show(full);
+        if (!same_ram(ei, ef)) {
+            printf("  random frame %u: dirty spans leave GDDRAM different from a full show\n", f);
+            return 1;
+        }
+    }
+
+    i2c_async_client_stats_t si, sf;
+    i2c_async_get_stats(bus_inc, 0, &si);
+    i2c_async_get_stats(bus_full, 0, &sf);
+    printf("%-18s %u frames: dirty spans %u bytes, full frames %u bytes\n", "random_spans", frames, si.bytes, sf.bytes);
+    return 0;
+}
+
+static bool read_pgm(const char *path, uint8_t *gray, uint32_t width, uint32_t height) {
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    unsigned w = 0, h = 0, max = 0;
+    bool ok = fscanf(f, "P5 %u %u %u", &w, &h, &max) == 3 && fgetc(f) != EOF &&
+              w == width && h == height && max == 255 &&
+              fread(gray, 1, width * height, f) == width * height;
+    fclose(f);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    const char *golden_dir = "golden";
+    const char *dump_dir = NULL;
+    bool update = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-u"))
+            update = true;
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+            dump_dir = argv[++i];
+        else if (!strcmp(argv[i], "-g") && i + 1 < argc)
+            golden_dir = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [-u] [-d DIR] [-g GOLDEN_DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // any unique pointer will do, the fake transports only compare them
+    static int bus_token, bus_full_token, spi_token;
+    i2c_inst_t *bus = (i2c_inst_t *)&bus_token;
+    i2c_inst_t *bus_full = (i2c_inst_t *)&bus_full_token;
+    spi_inst_t *spi = (spi_inst_t *)&spi_token;
+
+    static ssd1306_emu_t emu, emu_full, emu_spi;
+    ssd1306_emu_reset(&emu);
+    ssd1306_emu_reset(&emu_full);
+    i2c_async_init(bus, NULL, 0);
+    i2c_async_host_attach(bus, ADDR, &emu);
+    i2c_async_init(bus_full, NULL, 0);
+    i2c_async_host_attach(bus_full, ADDR, &emu_full);
+    spi_host_attach(spi, SPI_DC, SPI_CS, SPI_RST, &emu_spi);
+
+    ssd1306_t disp = {.external_vcc = false};
+    ssd1306_t disp_full = {.external_vcc = false};
+    ssd1306_t disp_spi = {.external_vcc = false};
+    if (!ssd1306_init(&disp, WIDTH, HEIGHT, ADDR, bus) ||
+        !ssd1306_init(&disp_full, WIDTH, HEIGHT, ADDR, bus_full) ||
+        !ssd1306_init_spi(&disp_spi, WIDTH, HEIGHT, spi, SPI_DC, SPI_CS, SPI_RST)) {
+        fprintf(stderr, "ssd1306_init failed\n");
+        return 1;
+    }
+    ssd1306_clear(&disp);
+    ssd1306_show(&disp);
+    ssd1306_clear(&disp_full);
+    ssd1306_show(&disp_full);
+    ssd1306_clear(&disp_spi);
+    ssd1306_show(&disp_spi);
+
+    int failures = 0;
+    static uint8_t frame[WIDTH * HEIGHT], golden[WIDTH * HEIGHT];
+    char path[512];
+
+    for (size_t s = 0; s < count_of(scenes); ++s) {
+        const scene_t *sc = &scenes[s];
+
+        i2c_async_reset_stats(bus);
+        spi_host_reset_stats();
+        draw_scene(&disp, sc);
+        ssd1306_show(&disp);
+        draw_scene(&disp_spi, sc);
+        ssd1306_show(&disp_spi);
+        draw_scene(&disp_full, sc);
+        ssd1306_invalidate(&disp_full);
+        ssd1306_show(&disp_full);
+
+        i2c_async_client_stats_t st;
+        spi_host_stats_t sst;
+        i2c_async_get_stats(bus, 0, &st);
+        spi_host_get_stats(&sst);
+        printf("%-18s i2c %3u transactions %5u bytes, spi %3u writes %5u bytes\n",
+               sc->name, st.transactions, st.bytes, sst.writes, sst.bytes);
+
+        // the partial updates must leave the panel RAM equal to the frame buffer, on either bus
+        bool in_sync = true, same = true;
+        for (uint32_t pg = 0; pg < disp.pages; ++pg) {
+            in_sync = in_sync && !memcmp(emu.ram[pg], disp.buffer + pg * WIDTH, WIDTH);
+            same = same && !memcmp(emu.ram[pg], emu_spi.ram[pg], WIDTH);
+        }
+        if (!in_sync) {
+            printf("  GDDRAM differs from the frame buffer\n");
+            ++failures;
+        }
+        if (!same) {
+            printf("  GDDRAM over SPI differs from GDDRAM over I2C\n");
+            ++failures;
+        }
+        if (!same_ram(&emu, &emu_full)) {
+            printf("  dirty spans leave GDDRAM different from a full show\n");
+            ++failures;
+        }
+
+        ssd1306_emu_render(&emu, WIDTH, HEIGHT, frame);
+        snprintf(path, sizeof(path), "%s/%s.pgm", golden_dir, sc->name);
+        if (update) {
+            if (!ssd1306_emu_write_pgm(&emu, WIDTH, HEIGHT, 1, path)) {
+                printf("  cannot write %s\n", path);
+                ++failures;
+            }
+        } else if (!read_pgm(path, golden, WIDTH, HEIGHT)) {
+            printf("  cannot read %s\n", path);
+            ++failures;
+        } else if (memcmp(frame, golden, sizeof(frame))) {
+            uint32_t diff = 0;
+            for (uint32_t i = 0; i < sizeof(frame); ++i)
+                diff += frame[i] != golden[i];
+            printf("  %u pixels differ from %s\n", diff, path);
+            ++failures;
+        }
+
+        if (dump_dir) {
+            snprintf(path, sizeof(path), "%s/%s.pgm", dump_dir, sc->name);
+            ssd1306_emu_write_pgm(&emu, WIDTH, HEIGHT, 4, path);
+        }
+    }
+
+    failures += check_random_spans(&disp, &emu, bus, &disp_full, &emu_full, bus_full, 2000);
+
+    if (emu.unknown_cmds || emu_full.unknown_cmds || emu_spi.unknown_cmds)
+        printf("%u unknown command bytes\n", emu.unknown_cmds + emu_full.unknown_cmds + emu_spi.unknown_cmds);
+
+    ssd1306_deinit(&disp);
+    ssd1306_deinit(&disp_full);
+    ssd1306_deinit(&disp_spi);
+    printf(failures ? "FAILED (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
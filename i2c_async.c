@@ -0,0 +1,287 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#include "i2c_async.h"
+
+// TX DREQ fires while the TX FIFO (16 deep) holds at most this many entries
+#define I2C_ASYNC_TX_LEVEL 4
+
+// How long a timed-out transaction gets to send its STOP before the block is disabled
+#define I2C_ASYNC_ABORT_US 200
+
+typedef struct {
+    i2c_inst_t *i2c;
+    uint tx_dma;
+    uint rx_dma;
+    uint16_t *cmd;
+    uint32_t cmd_words;
+    spin_lock_t *lock;
+    i2c_async_txn_t *head;  // on the wire
+    i2c_async_txn_t *tail;
+    bool aborted;           // TX_ABRT seen for the head transaction
+    bool ready;
+    i2c_async_client_stats_t stats[I2C_ASYNC_MAX_CLIENTS];
+} i2c_async_bus_t;
+
+static i2c_async_bus_t g_bus[2];
+
+static inline uint32_t txn_words(const i2c_async_txn_t *t) {
+    return (uint32_t)t->hdr_len + t->tx_len + t->rx_len;
+}
+
+static inline uint32_t txn_timeout_us(const i2c_async_txn_t *t) {
+    return I2C_ASYNC_TIMEOUT_US + (txn_words(t) + 1) * I2C_ASYNC_BYTE_TIMEOUT_US;
+}
+
+// Expand the head transaction into IC_DATA_CMD words and hand them to DMA. Lock held.
+static void bus_start(i2c_async_bus_t *b) {
+    i2c_async_txn_t *t = b->head;
+    i2c_hw_t *hw = i2c_get_hw(b->i2c);
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < t->hdr_len; ++i) b->cmd[n++] = t->hdr[i];
+    for (uint32_t i = 0; i < t->tx_len; ++i) b->cmd[n++] = t->tx[i];
+    for (uint32_t i = 0; i < t->rx_len; ++i) {
+        uint16_t w = I2C_IC_DATA_CMD_CMD_BITS;
+        if (i == 0 && n > 0) w |= I2C_IC_DATA_CMD_RESTART_BITS;
+        b->cmd[n++] = w;
+    }
+    b->cmd[n - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    // target address can only change while the block is disabled
+    hw->enable = 0;
+    hw->tar = t->addr;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+
+    b->aborted = false;
+    t->status = I2C_ASYNC_BUSY;
+    t->t_start = time_us_32();
+
+    i2c_async_client_stats_t *st = &b->stats[t->client];
+    uint32_t wait = t->t_start - t->t_queued;
+    st->wait_us += wait;
+    if (wait > st->wait_max_us) st->wait_max_us = wait;
+
+    if (t->rx_len) {
+        dma_channel_config c = dma_channel_get_default_config(b->rx_dma);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_dreq(&c, i2c_get_dreq(b->i2c, false));
+        dma_channel_configure(b->rx_dma, &c, t->rx, &hw->data_cmd, t->rx_len, true);
+    }
+
+    // 16-bit writes are replicated across the bus; bits above CMD/STOP/RESTART are ignored
+    dma_channel_config c = dma_channel_get_default_config(b->tx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(b->i2c, true));
+    dma_channel_configure(b->tx_dma, &c, &hw->data_cmd, b->cmd, n, true);
+}
+
+// Take the head transaction off the bus and start the next one. Lock held; the caller publishes the result.
+static i2c_async_txn_t *bus_retire(i2c_async_bus_t *b, bool ok) {
+    i2c_async_txn_t *t = b->head;
+    i2c_async_client_stats_t *st = &b->stats[t->client];
+    st->transactions++;
+    st->bytes += txn_words(t);
+    st->busy_us += time_us_32() - t->t_start;
+    if (!ok) st->errors++;
+
+    b->head = t->next;
+    if (!b->head)
+        b->tail = NULL;
+    else
+        bus_start(b);
+    return t;
+}
+
+static void txn_finish(i2c_async_txn_t *t, bool ok) {
+    t->next = NULL;
+    t->status = ok ? I2C_ASYNC_DONE : I2C_ASYNC_ERROR;
+    if (t->callback)
+        t->callback(t);
+}
+
+static void bus_irq(i2c_async_bus_t *b) {
+    i2c_hw_t *hw = i2c_get_hw(b->i2c);
+
+    // flags are read under the lock: a timeout on the other core may have retired the head and cleared them
+    uint32_t save = spin_lock_blocking(b->lock);
+    uint32_t stat = hw->intr_stat;
+
+    if (stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // the FIFO stays flushed until TX_ABRT is cleared, so stop feeding it first
+        dma_channel_abort(b->tx_dma);
+        dma_channel_abort(b->rx_dma);
+        b->aborted = true;
+        (void)hw->clr_tx_abrt;
+    }
+    if (!(stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS)) {
+        spin_unlock(b->lock, save);
+        return;
+    }
+    (void)hw->clr_stop_det;
+
+    if (!b->head) {
+        spin_unlock(b->lock, save);
+        return;
+    }
+    bool ok = !b->aborted;
+    // the last byte may still be on its way from the RX FIFO
+    if (ok && b->head->rx_len)
+        while (dma_channel_is_busy(b->rx_dma))
+            tight_loop_contents();
+
+    i2c_async_txn_t *t = bus_retire(b, ok);
+    spin_unlock(b->lock, save);
+    txn_finish(t, ok);
+}
+
+// Abort the head transaction once it is on the wire longer than its deadline
+static void bus_check_timeout(i2c_async_bus_t *b) {
+    i2c_async_txn_t *t = b->head;
+    if (!b->ready || !t || t->status != I2C_ASYNC_BUSY || time_us_32() - t->t_start <= txn_timeout_us(t))
+        return;
+
+    uint32_t save = spin_lock_blocking(b->lock);
+    if (b->head != t || t->status != I2C_ASYNC_BUSY || time_us_32() - t->t_start <= txn_timeout_us(t)) {
+        // finished or retired meanwhile
+        spin_unlock(b->lock, save);
+        return;
+    }
+    i2c_hw_t *hw = i2c_get_hw(b->i2c);
+    dma_channel_abort(b->tx_dma);
+    dma_channel_abort(b->rx_dma);
+    // ABORT flushes the TX FIFO and sends STOP; a device holding SCL low keeps it from finishing,
+    // so give it I2C_ASYNC_ABORT_US and then disable the block regardless
+    hw->enable |= I2C_IC_ENABLE_ABORT_BITS;
+    uint32_t t0 = time_us_32();
+    while ((hw->enable & I2C_IC_ENABLE_ABORT_BITS) && time_us_32() - t0 < I2C_ASYNC_ABORT_US)
+        tight_loop_contents();
+    hw->enable = 0;
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+
+    t = bus_retire(b, false);
+    spin_unlock(b->lock, save);
+    txn_finish(t, false);
+}
+
+static void i2c0_async_irq(void) {
+    bus_irq(&g_bus[0]);
+}
+
+static void i2c1_async_irq(void) {
+    bus_irq(&g_bus[1]);
+}
+
+void i2c_async_init(i2c_inst_t *i2c, uint16_t *cmd_buf, uint32_t cmd_words) {
+    uint idx = i2c_hw_index(i2c);
+    i2c_async_bus_t *b = &g_bus[idx];
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+
+    b->i2c = i2c;
+    b->cmd = cmd_buf;
+    b->cmd_words = cmd_words;
+    b->tx_dma = (uint)dma_claim_unused_channel(true);
+    b->rx_dma = (uint)dma_claim_unused_channel(true);
+    b->lock = spin_lock_init((uint)spin_lock_claim_unused(true));
+    b->head = b->tail = NULL;
+
+    // i2c_init() already enables both DREQs
+    hw->dma_tdlr = I2C_ASYNC_TX_LEVEL;
+    hw->dma_rdlr = 0;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+
+    irq_set_exclusive_handler(I2C0_IRQ + idx, idx ? i2c1_async_irq : i2c0_async_irq);
+    irq_set_enabled(I2C0_IRQ + idx, true);
+    b->ready = true;
+}
+
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    i2c_async_bus_t *b = &g_bus[i2c_hw_index(i2c)];
+    if (!b->ready)
+        return false;
+    if (txn->status == I2C_ASYNC_QUEUED || txn->status == I2C_ASYNC_BUSY)
+        return false;
+
+    uint32_t words = txn_words(txn);
+    if (words == 0 || words > b->cmd_words || txn->client >= I2C_ASYNC_MAX_CLIENTS) {
+        txn->status = I2C_ASYNC_ERROR;
+        return false;
+    }
+
+    txn->next = NULL;
+    txn->status = I2C_ASYNC_QUEUED;
+    txn->t_queued = time_us_32();
+
+    uint32_t save = spin_lock_blocking(b->lock);
+    if (!b->head) {
+        b->head = b->tail = txn;
+        bus_start(b);
+    } else {
+        // the head is already on the wire; insert behind the last entry of equal or higher priority
+        i2c_async_txn_t *p = b->head;
+        while (p->next && p->next->prio >= txn->prio)
+            p = p->next;
+        txn->next = p->next;
+        p->next = txn;
+        if (!txn->next)
+            b->tail = txn;
+    }
+    spin_unlock(b->lock, save);
+    return true;
+}
+
+bool i2c_async_wait(i2c_async_txn_t *txn) {
+    if (txn->status == I2C_ASYNC_IDLE)
+        return false;
+    // txn does not know its bus, and a queued one waits for whatever is on the wire
+    while (!i2c_async_finished(txn)) {
+        bus_check_timeout(&g_bus[0]);
+        bus_check_timeout(&g_bus[1]);
+    }
+    return txn->status == I2C_ASYNC_DONE;
+}
+
+bool i2c_async_busy(i2c_inst_t *i2c) {
+    i2c_async_bus_t *b = &g_bus[i2c_hw_index(i2c)];
+    bus_check_timeout(b);
+    return b->head != NULL;
+}
+
+bool i2c_async_transfer_blocking(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    if (!i2c_async_submit(i2c, txn))
+        return false;
+    return i2c_async_wait(txn);
+}
+
+void i2c_async_get_stats(i2c_inst_t *i2c, uint8_t client, i2c_async_client_stats_t *stats) {
+    i2c_async_bus_t *b = &g_bus[i2c_hw_index(i2c)];
+    if (client >= I2C_ASYNC_MAX_CLIENTS || !b->ready) {
+        *stats = (i2c_async_client_stats_t){0};
+        return;
+    }
+    uint32_t save = spin_lock_blocking(b->lock);
+    *stats = b->stats[client];
+    spin_unlock(b->lock, save);
+}
+
+void i2c_async_reset_stats(i2c_inst_t *i2c) {
+    i2c_async_bus_t *b = &g_bus[i2c_hw_index(i2c)];
+    if (!b->ready)
+        return;
+    uint32_t save = spin_lock_blocking(b->lock);
+    for (uint32_t i = 0; i < I2C_ASYNC_MAX_CLIENTS; ++i)
+        b->stats[i] = (i2c_async_client_stats_t){0};
+    spin_unlock(b->lock, save);
+}
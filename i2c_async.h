@@ -0,0 +1,112 @@
+#ifndef I2C_ASYNC_H
+#define I2C_ASYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/i2c.h"
+
+typedef enum {
+    I2C_ASYNC_IDLE = 0,     // never submitted
+    I2C_ASYNC_QUEUED,       // waiting for the bus
+    I2C_ASYNC_BUSY,         // on the wire
+    I2C_ASYNC_DONE,         // finished, all bytes acknowledged
+    I2C_ASYNC_ERROR         // aborted (NACK, timeout) or did not fit the command buffer
+} i2c_async_status_t;
+
+// Queue order: a higher priority overtakes everything still waiting, never the transaction on the wire
+typedef enum {
+    I2C_ASYNC_PRIO_LOW = 0,
+    I2C_ASYNC_PRIO_NORMAL,
+    I2C_ASYNC_PRIO_HIGH
+} i2c_async_prio_t;
+
+/*
+ * A transaction on the wire longer than I2C_ASYNC_TIMEOUT_US plus
+ * I2C_ASYNC_BYTE_TIMEOUT_US per byte (address included) is aborted and ends
+ * in ERROR, so a device holding SCL low cannot hang a waiter. The deadline is
+ * checked by i2c_async_wait() and i2c_async_busy(), not by the interrupt.
+ */
+#ifndef I2C_ASYNC_TIMEOUT_US
+#define I2C_ASYNC_TIMEOUT_US 1000
+#endif
+#ifndef I2C_ASYNC_BYTE_TIMEOUT_US
+#define I2C_ASYNC_BYTE_TIMEOUT_US 100   // a byte at 100 kHz takes 90 us
+#endif
+
+// Statistics are kept per client id (0 .. I2C_ASYNC_MAX_CLIENTS-1), chosen by the caller
+#ifndef I2C_ASYNC_MAX_CLIENTS
+#define I2C_ASYNC_MAX_CLIENTS 4
+#endif
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t errors;
+    uint32_t bytes;         // bytes on the wire, address byte excluded
+    uint64_t wait_us;       // sum of queueing delays (submit -> start)
+    uint32_t wait_max_us;
+    uint64_t busy_us;       // sum of bus occupancy (start -> STOP)
+} i2c_async_client_stats_t;
+
+typedef struct i2c_async_txn i2c_async_txn_t;
+
+// Called from the I2C interrupt once the transaction has finished (status is DONE or ERROR)
+typedef void (*i2c_async_callback_t)(i2c_async_txn_t *txn);
+
+/*
+ * Transaction descriptor. Owned by the caller and must stay valid, together
+ * with every buffer it points to, until the transaction has finished.
+ * On the wire: START addr+W, hdr bytes, tx bytes, then (if rx_len) RESTART
+ * addr+R and rx_len bytes read, then STOP.
+ */
+struct i2c_async_txn {
+    uint8_t addr;                   // 7-bit device address
+    const uint8_t *hdr;             // e.g. register or memory address, may be NULL
+    uint8_t hdr_len;
+    const uint8_t *tx;              // payload written after hdr, may be NULL
+    uint16_t tx_len;
+    uint8_t *rx;                    // read buffer, may be NULL
+    uint16_t rx_len;
+    uint8_t prio;                   // i2c_async_prio_t
+    uint8_t client;                 // statistics slot
+    i2c_async_callback_t callback;  // optional
+    void *user;                     // free for the callback
+    volatile i2c_async_status_t status;
+    i2c_async_txn_t *next;          // queue link, owned by the transport
+    uint32_t t_queued;              // timestamps, owned by the transport
+    uint32_t t_start;
+};
+
+/*
+ * Attach the transport to an already initialised I2C instance (i2c_init()).
+ * Every byte on the wire takes one 16-bit command word, so cmd_buf must hold
+ * hdr_len + tx_len + rx_len words of the largest transaction. The I2C IRQ is
+ * enabled on the calling core.
+ *
+ * The transport is the only owner of the bus: transactions submitted from
+ * either core are serialised through one queue guarded by a hardware spin
+ * lock and never interleave on the wire.
+ */
+void i2c_async_init(i2c_inst_t *i2c, uint16_t *cmd_buf, uint32_t cmd_words);
+
+// Queue a transaction by priority; returns false if the transport is not initialised or txn is still in use
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_txn_t *txn);
+
+// Non-blocking check whether txn has finished (DONE or ERROR); does not check the deadline
+static inline bool i2c_async_finished(const i2c_async_txn_t *txn) {
+    return txn->status == I2C_ASYNC_DONE || txn->status == I2C_ASYNC_ERROR;
+}
+
+// Wait for txn to finish, aborting a transaction past its deadline on either bus; returns true on DONE
+bool i2c_async_wait(i2c_async_txn_t *txn);
+
+// True while anything is queued or on the wire; aborts the transaction on the wire past its deadline
+bool i2c_async_busy(i2c_inst_t *i2c);
+
+// Submit and wait – drop-in replacement for i2c_write_blocking()/i2c_read_blocking() pairs
+bool i2c_async_transfer_blocking(i2c_inst_t *i2c, i2c_async_txn_t *txn);
+
+// Contention statistics of one client; the copy is consistent across cores
+void i2c_async_get_stats(i2c_inst_t *i2c, uint8_t client, i2c_async_client_stats_t *stats);
+void i2c_async_reset_stats(i2c_inst_t *i2c);
+
+#endif
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "latency.h"
+
+static const char *const stage_names[LATENCY_STAGES] = {
+    "input->queued", "queued->dequeued", "dequeued->planned", "planned->i2c done", "total",
+};
+
+static uint32_t bucket_of(uint32_t us) {
+    if (us < 8)
+        return us;
+    uint32_t msb = 31 - __builtin_clz(us);
+    uint32_t b = 8 + (msb - 3) * 4 + ((us >> (msb - 2)) & 3);
+    return b < LATENCY_BUCKETS ? b : LATENCY_BUCKETS - 1;
+}
+
+// largest value that falls into bucket b
+static uint32_t bucket_top(uint32_t b) {
+    if (b < 8)
+        return b;
+    uint32_t msb = 3 + (b - 8) / 4;
+    uint32_t low = 1u << msb | (b - 8) % 4 << (msb - 2);
+    return low + (1u << (msb - 2)) - 1;
+}
+
+static void hist_add(latency_hist_t *h, uint64_t from, uint64_t to) {
+    uint64_t d = to > from ? to - from : 0;
+    uint32_t us = d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+    if (!h->count || us < h->min_us)
+        h->min_us = us;
+    if (us > h->max_us)
+        h->max_us = us;
+    h->sum_us += us;
+    ++h->count;
+    ++h->hist[bucket_of(us)];
+}
+
+void latency_reset(latency_stats_t *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+void latency_record(latency_stats_t *s, const latency_trace_t *t) {
+    hist_add(&s->stage[LATENCY_QUEUE], t->input, t->queued);
+    hist_add(&s->stage[LATENCY_WAKE], t->queued, t->dequeued);
+    hist_add(&s->stage[LATENCY_PLAN], t->dequeued, t->planned);
+    hist_add(&s->stage[LATENCY_I2C], t->planned, t->done);
+    hist_add(&s->stage[LATENCY_TOTAL], t->input, t->done);
+}
+
+uint32_t latency_percentile(const latency_hist_t *h, uint32_t per_mille) {
+    if (!h->count)
+        return 0;
+    // rank of the value, rounded up: p99 of 100 samples is the 99th
+    uint64_t rank = ((uint64_t)h->count * per_mille + 999) / 1000;
+    if (rank == 0)
+        rank = 1;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < LATENCY_BUCKETS; ++b) {
+        seen += h->hist[b];
+        if (seen >= rank) {
+            // the last bucket has no upper bound of its own
+            uint32_t top = b < LATENCY_BUCKETS - 1 ? bucket_top(b) : h->max_us;
+            return top < h->max_us ? top : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+void latency_dump(const latency_stats_t *s) {
+    printf("%-18s %8s %10s %10s %10s %10s\n", "stage [us]", "count", "min", "mean", "p99", "max");
+    for (int i = 0; i < LATENCY_STAGES; ++i) {
+        const latency_hist_t *h = &s->stage[i];
+        uint32_t mean = h->count ? (uint32_t)(h->sum_us / h->count) : 0;
+        printf("%-18s %8lu %10lu %10lu %10lu %10lu\n", stage_names[i], (unsigned long)h->count,
+               (unsigned long)h->min_us, (unsigned long)mean, (unsigned long)latency_percentile(h, 990),
+               (unsigned long)h->max_us);
+    }
+}
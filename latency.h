@@ -0,0 +1,56 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Stages from a confirmed input to the RF change; each one is the time since the previous stage
+typedef enum {
+    LATENCY_QUEUE = 0,      // input detected -> message queued (core1, EEPROM store included)
+    LATENCY_WAKE,           // queued -> dequeued by the core0 dispatcher
+    LATENCY_PLAN,           // dequeued -> plan done and register bursts queued
+    LATENCY_I2C,            // bursts queued -> I2C done, PLL reset settled
+    LATENCY_TOTAL,          // input detected -> I2C done
+    LATENCY_STAGES
+} latency_stage_t;
+
+// time_us_64() at each stage of one input
+typedef struct {
+    uint64_t input;
+    uint64_t queued;
+    uint64_t dequeued;
+    uint64_t planned;
+    uint64_t done;
+} latency_trace_t;
+
+// Below 8 us one bucket per microsecond, above that four per power of two
+// (at most 25% wide); the last bucket also takes everything beyond ~16 s.
+#ifndef LATENCY_BUCKETS
+#define LATENCY_BUCKETS 96
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t hist[LATENCY_BUCKETS];
+} latency_hist_t;
+
+// One writer: record, reset and dump all run on the same core
+typedef struct {
+    latency_hist_t stage[LATENCY_STAGES];
+} latency_stats_t;
+
+void latency_reset(latency_stats_t *s);
+
+// Adds one input; stamps must not go backwards
+void latency_record(latency_stats_t *s, const latency_trace_t *t);
+
+// Upper bound of the bucket holding the per_mille-th value (990: p99), clamped to max_us; 0 if empty
+uint32_t latency_percentile(const latency_hist_t *h, uint32_t per_mille);
+
+// Table of min/mean/p99/max per stage, for the USB CDC console
+void latency_dump(const latency_stats_t *s);
+
+#endif
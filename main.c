@@ -5,7 +5,6 @@
 #include "hardware/uart.h"
 #include <math.h>
 #include "pico/binary_info.h"
-#include "pico/util/queue.h"
 #include "pico/sem.h"
 #include <string.h>
 #include <stdlib.h>
@@ -18,9 +17,13 @@
 #include "main.h"
 #include "BMSPA_font.h"
 #include "core1_entry.h"
-#include "at24c256.h"
+#include "AT24C256.h"
+#include "i2c_async.h"
 #include "core1_entry.h"
 #include "Si5351.h"
+#include "sweep.h"
+#include "core_msg.h"
+#include "latency.h"
 
 
 
@@ -34,12 +37,67 @@
 #define UART_TX_PIN 4
 #define UART_RX_PIN 5
 
+// DMA command words for I2C0: one per byte of the longest transaction (EEPROM page + address)
+static uint16_t i2c0_cmd[80];
+
+static void core0_reply(uint8_t msgId, uint32_t value) {
+    const core_msg_t reply = {.objId = CORE_OBJ_STATUS, .msgId = msgId, .status.value = value};
+    if (core_msg_push(&core0_to_core1_ring, &reply))
+        __sev();
+}
+
+// input-to-RF latency, recorded and dumped only on core0
+static latency_stats_t freq_latency;
+
+static void on_freq(const core_msg_t *m) {
+    latency_trace_t t = {.input = m->t_input_us, .queued = m->t_queued_us, .dequeued = time_us_64()};
+
+    // CLK0 belongs to a running sweep until it is stopped
+    sweep_stop();
+    // si5351_clk0_set() in two halves, so the planning and the bus time are seen apart
+    bool pll_reset;
+    if (!si5351_clk0_set_async(m->freq.hz, &pll_reset)) {
+        core0_reply(CORE_STATUS_ERROR, CORE_OBJ_FREQ);
+        return;
+    }
+    t.planned = time_us_64();
+    bool ok = si5351_finish(pll_reset);
+    t.done = time_us_64();
+    if (!ok) {
+        core0_reply(CORE_STATUS_ERROR, CORE_OBJ_FREQ);
+        return;
+    }
+    if (t.input)
+        latency_record(&freq_latency, &t);
+
+    uint32_t freq_check = si5351_clk0_get_hz();
+    printf("Nowa częstotliwość CLK0: %u Hz\n", freq_check);
+    core0_reply(CORE_STATUS_FREQ, freq_check);
+}
+
+static void on_sweep(const core_msg_t *m) {
+    if (m->msgId == CORE_SWEEP_STOP) {
+        sweep_stop();
+        return;
+    }
+    sweep_stop();
+    if (!sweep_prepare(&m->sweep) || !sweep_start())
+        core0_reply(CORE_STATUS_ERROR, CORE_OBJ_SWEEP);
+}
+
+// Work core1 can post to core0, by objId; NULL entries are dropped
+static const core_msg_handler_t core0_handlers[CORE_OBJ_COUNT] = {
+    [CORE_OBJ_FREQ] = on_freq,
+    [CORE_OBJ_SWEEP] = on_sweep,
+};
+
 int main()
 { 
     stdio_init_all();
 
-    queue_init(&core0_to_core1_queue, sizeof(queue_entry_t), 10);
-    queue_init(&core1_to_core0_queue, sizeof(queue_entry_t), 10);
+    // only the newest of several frequencies (or replies) queued in a row is delivered
+    core_msg_ring_init(&core0_to_core1_ring, 1u << CORE_OBJ_STATUS);
+    core_msg_ring_init(&core1_to_core0_ring, 1u << CORE_OBJ_FREQ);
 
     // I2C Initialisation. Using it at 400Khz.
     i2c_init(I2C0_PORT, 400*1000);
@@ -47,6 +105,7 @@ int main()
     gpio_set_function(I2C0_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C0_SDA);
     gpio_pull_up(I2C0_SCL);
+    i2c_async_init(I2C0_PORT, i2c0_cmd, count_of(i2c0_cmd));
 
     // Set up our UART
     uart_init(UART_ID, BAUD_RATE);
@@ -61,8 +120,8 @@ int main()
     setup();
     si5351_init();
 
-    queue_entry_t msg = {.msgId = READY_FLAG, .objId = 0, .command = 0, .dataPtr = NULL, .dataLen = 0};
-    queue_add_blocking(&core0_to_core1_queue, &msg);
+    const core_msg_t ready = {.objId = CORE_OBJ_STATUS, .msgId = CORE_STATUS_READY};
+    core_msg_push(&core0_to_core1_ring, &ready);
     multicore_launch_core1(core1_entry);
 
     int digits1[NUM_DIGITS] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
@@ -83,17 +142,21 @@ int main()
 
     //uint32_t freq_check = si5351_get_freq();
     
+    // core1 SEVs after every push. A SEV that lands between an empty ring and
+    // the WFE is latched in the event register, so the WFE returns at once and
+    // no message waits for the next wake-up; interrupts end the WFE as well.
+    latency_reset(&freq_latency);
     while (1) {
-        queue_entry_t msg;
-    if (queue_try_remove(&core1_to_core0_queue, &msg)) {
-        if (msg.objId == TARGET_T) {
-            uint32_t new_freq = *(uint32_t *)msg.dataPtr;
-            si5351_clk0_set(new_freq);
-            uint32_t freq_check = si5351_clk0_get_hz();
-            printf("Nowa częstotliwość CLK0: %u Hz\n", freq_check);
-        }
+        if (core_msg_dispatch(&core1_to_core0_ring, core0_handlers))
+            continue;
+        // console on USB CDC: 'l' prints the latency table, 'r' starts it over
+        int c = getchar_timeout_us(0);
+        if (c == 'l')
+            latency_dump(&freq_latency);
+        else if (c == 'r')
+            latency_reset(&freq_latency);
+        else if (c == PICO_ERROR_TIMEOUT)
+            __wfe();
     }
-    sleep_ms(100); // Krótkie opóźnienie
-}
     return 0;
 }
@@ -3,8 +3,24 @@
 #define I2C1_SCL 7
 #define SLEEPTIME 25
 
+// OLED on SPI0 instead of I2C1 (build with -DOLED_SPI=1), SCK/MOSI on the I2C1 pins
+#ifndef OLED_SPI
+#define OLED_SPI 0
+#endif
+#define OLED_SPI_PORT spi0
+#define OLED_SPI_SCK  6
+#define OLED_SPI_MOSI 7
+#define OLED_SPI_DC   8
+#define OLED_SPI_CS   9
+#define OLED_SPI_RST  10
+#define OLED_SPI_BAUD (10*1000*1000)
+
 #define I2C0_PORT i2c0
 #define I2C0_SDA 0
 #define I2C0_SCL 1
 #define I2C_FREQ 100000 // 100 kHz
-#define AT24C256_ADDR 0x50
\ No newline at end of file
+#define AT24C256_ADDR 0x50
+
+// I2C0 bus clients (statistics slots of the i2c_async arbiter)
+#define I2C0_CLIENT_SI5351 0
+#define I2C0_CLIENT_EEPROM 1
\ No newline at end of file
@@ -6,41 +6,106 @@
 #include <stdio.h>
 
 #include "ssd1306.h"
+#include "ssd1306_bus.h"
 #include "font.h"
 
 inline static void swap(int32_t *a, int32_t *b) {
-    int32_t *t=a;
+    int32_t t=*a;
     *a=*b;
-    *b=*t;
+    *b=t;
 }
 
-inline static void fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, char *name) {
-    switch(i2c_write_blocking(i2c, addr, src, len, false)) {
-    case PICO_ERROR_GENERIC:
-        printf("[%s] addr not acknowledged!\n", name);
-        break;
-    case PICO_ERROR_TIMEOUT:
-        printf("[%s] timeout!\n", name);
-        break;
-    default:
-        //printf("[%s] wrote successfully %lu bytes!\n", name, len);
-        break;
+inline static bool fancy_write(ssd1306_t *p, const uint8_t *src, size_t len, char *name) {
+    if(!p->bus->write(p, src, len)) {
+        printf("[%s] write failed!\n", name);
+        return false;
     }
+    return true;
 }
 
-inline static void ssd1306_write(ssd1306_t *p, uint8_t val) {
-    uint8_t d[2]= {0x00, val};
-    fancy_write(p->i2c_i, p->address, d, 2, "ssd1306_write");
+void ssd1306_cmdlist_init(ssd1306_cmdlist_t *l, uint8_t *storage, size_t size) {
+    l->buf=storage;
+    l->size=size;
+    l->len=0;
+    l->overflow=size==0;
+    if(size)
+        l->buf[l->len++]=0x00; // Co=0, D/C#=0: every following byte is a command
 }
 
-bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance) {
+void ssd1306_cmdlist_add(ssd1306_cmdlist_t *l, uint8_t b) {
+    if(l->len>=l->size) {
+        l->overflow=true;
+        return;
+    }
+    l->buf[l->len++]=b;
+}
+
+void ssd1306_cmdlist_add_n(ssd1306_cmdlist_t *l, const uint8_t *b, size_t n) {
+    for(size_t i=0; i<n; ++i)
+        ssd1306_cmdlist_add(l, b[i]);
+}
+
+bool ssd1306_cmdlist_send(ssd1306_t *p, const ssd1306_cmdlist_t *l) {
+    if(l->overflow || l->len<2)
+        return false;
+    return fancy_write(p, l->buf, l->len, "ssd1306_cmdlist");
+}
+
+// short command sequences: up to four bytes in one transaction
+inline static void ssd1306_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n) {
+    uint8_t storage[5];
+    ssd1306_cmdlist_t l;
+    ssd1306_cmdlist_init(&l, storage, sizeof(storage));
+    ssd1306_cmdlist_add_n(&l, cmds, n);
+    ssd1306_cmdlist_send(p, &l);
+}
+
+// front buffer bytes of a window besides the data: command list (control byte + six commands) and the data control byte
+#define SSD1306_WINDOW_HDR 8
+
+inline static void ssd1306_mark(ssd1306_t *p, uint32_t x, uint32_t page) {
+    if(x<p->dirty_lo[page]) p->dirty_lo[page]=x;
+    if(x>p->dirty_hi[page]) p->dirty_hi[page]=x;
+}
+
+inline static void ssd1306_mark_all(ssd1306_t *p) {
+    for(uint32_t i=0; i<p->pages; ++i) {
+        p->dirty_lo[i]=0;
+        p->dirty_hi[i]=p->width-1;
+    }
+}
+
+inline static void ssd1306_mark_clean(ssd1306_t *p, uint32_t page) {
+    p->dirty_lo[page]=0xFF;
+    p->dirty_hi[page]=0;
+}
+
+// bit j of the index repeated 2 resp. 3 times, filled by ssd1306_init
+static uint16_t scale2_tab[256];
+static uint32_t scale3_tab[256];
+
+static void ssd1306_scale_tables_init(void) {
+    for(uint32_t b=0; b<256; ++b) {
+        uint16_t d=0;
+        uint32_t t=0;
+        for(uint32_t j=0; j<8; ++j) {
+            if(b&(1u<<j)) {
+                d|=3u<<(2*j);
+                t|=7u<<(3*j);
+            }
+        }
+        scale2_tab[b]=d;
+        scale3_tab[b]=t;
+    }
+}
+
+bool ssd1306_init_core(ssd1306_t *p, uint16_t width, uint16_t height) {
     p->width=width;
     p->height=height;
     p->pages=height/8;
-    p->address=address;
-
-    p->i2c_i=i2c_instance;
 
+    if(p->pages>SSD1306_MAX_PAGES)
+        return false;
 
     p->bufsize=(p->pages)*(p->width);
     if((p->buffer=malloc(p->bufsize+1))==NULL) {
@@ -50,6 +115,21 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
 
     ++(p->buffer);
 
+    p->sent=malloc(p->bufsize);
+    p->front=malloc(p->bufsize+SSD1306_MAX_PAGES*SSD1306_WINDOW_HDR);
+    if(p->sent==NULL || p->front==NULL) {
+        free(p->sent);
+        free(p->front);
+        free(p->buffer-1);
+        p->bufsize=0;
+        return false;
+    }
+    p->sent_valid=false;
+    p->frame_bytes=0;
+    p->windows=0;
+    ssd1306_mark_all(p);
+    ssd1306_scale_tables_init();
+
     // from https://github.com/makerportal/rpi-pico-ssd1306
     uint8_t cmds[]= {
         SET_DISP,
@@ -84,47 +164,103 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
         0x00,  // horizontal
     };
 
-    for(size_t i=0; i<sizeof(cmds); ++i)
-        ssd1306_write(p, cmds[i]);
+    uint8_t list[sizeof(cmds)+1];
+    ssd1306_cmdlist_t l;
+    ssd1306_cmdlist_init(&l, list, sizeof(list));
+    ssd1306_cmdlist_add_n(&l, cmds, sizeof(cmds));
+    ssd1306_cmdlist_send(p, &l);
 
     return true;
 }
 
 inline void ssd1306_deinit(ssd1306_t *p) {
     free(p->buffer-1);
+    free(p->sent);
+    free(p->front);
 }
 
 inline void ssd1306_poweroff(ssd1306_t *p) {
-    ssd1306_write(p, SET_DISP|0x00);
+    const uint8_t cmds[]= {SET_DISP|0x00};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
 }
 
 inline void ssd1306_poweron(ssd1306_t *p) {
-    ssd1306_write(p, SET_DISP|0x01);
+    const uint8_t cmds[]= {SET_DISP|0x01};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
 }
 
 inline void ssd1306_contrast(ssd1306_t *p, uint8_t val) {
-    ssd1306_write(p, SET_CONTRAST);
-    ssd1306_write(p, val);
+    const uint8_t cmds[]= {SET_CONTRAST, val};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
 }
 
 inline void ssd1306_invert(ssd1306_t *p, uint8_t inv) {
-    ssd1306_write(p, SET_NORM_INV | (inv & 1));
+    const uint8_t cmds[]= {SET_NORM_INV | (inv & 1)};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
 }
 
 inline void ssd1306_clear(ssd1306_t *p) {
     memset(p->buffer, 0, p->bufsize);
+    ssd1306_mark_all(p);
 }
 
 void ssd1306_clear_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
     if(x>=p->width || y>=p->height) return;
 
     p->buffer[x+p->width*(y>>3)]&=~(0x1<<(y&0x07));
+    ssd1306_mark(p, x, y>>3);
 }
 
 void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
     if(x>=p->width || y>=p->height) return;
 
     p->buffer[x+p->width*(y>>3)]|=0x1<<(y&0x07); // y>>3==y/8 && y&0x7==y%8
+    ssd1306_mark(p, x, y>>3);
+}
+
+// set or clear a clipped rectangle, one masked byte per page and column
+static void ssd1306_fill_rect(ssd1306_t *p, int32_t x, int32_t y, int32_t width, int32_t height, bool set) {
+    if(width<=0 || height<=0)
+        return;
+
+    int32_t x_end=x+width, y_end=y+height;
+    if(x<0) x=0;
+    if(y<0) y=0;
+    if(x_end>p->width) x_end=p->width;
+    if(y_end>p->height) y_end=p->height;
+    if(x>=x_end || y>=y_end)
+        return;
+
+    for(int32_t pg=y>>3; pg<=(y_end-1)>>3; ++pg) {
+        int32_t top=pg<<3;
+        int32_t lo=y>top?y-top:0;
+        int32_t hi=y_end<top+8?y_end-top:8;
+        uint8_t mask=(uint8_t) ((0xFFu<<lo)&(0xFFu>>(8-hi)));
+        uint8_t *row=p->buffer+pg*p->width;
+
+        if(set)
+            for(int32_t i=x; i<x_end; ++i)
+                row[i]|=mask;
+        else
+            for(int32_t i=x; i<x_end; ++i)
+                row[i]&=~mask;
+
+        ssd1306_mark(p, x, pg);
+        ssd1306_mark(p, x_end-1, pg);
+    }
+}
+
+// coordinates beyond int16 are off screen anyway
+static inline int32_t ssd1306_clamp_len(uint32_t v) {
+    return v>0x7FFF?0x7FFF:(int32_t) v;
+}
+
+void ssd1306_draw_hline(ssd1306_t *p, int32_t x, int32_t y, uint32_t width) {
+    ssd1306_fill_rect(p, x, y, ssd1306_clamp_len(width), 1, true);
+}
+
+void ssd1306_draw_vline(ssd1306_t *p, int32_t x, int32_t y, uint32_t height) {
+    ssd1306_fill_rect(p, x, y, 1, ssd1306_clamp_len(height), true);
 }
 
 void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
@@ -133,45 +269,82 @@ void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t
         swap(&y1, &y2);
     }
 
+    if(y1==y2) {
+        ssd1306_draw_hline(p, x1, y1, x2-x1+1);
+        return;
+    }
+
     if(x1==x2) {
         if(y1>y2)
             swap(&y1, &y2);
-        for(int32_t i=y1; i<=y2; ++i)
-            ssd1306_draw_pixel(p, x1, i);
+        ssd1306_draw_vline(p, x1, y1, y2-y1+1);
         return;
     }
 
-    float m=(float) (y2-y1) / (float) (x2-x1);
+    // Bresenham, all octants
+    int32_t dx=x2-x1, dy=-abs(y2-y1);
+    int32_t sy=y1<y2?1:-1;
+    int32_t err=dx+dy;
 
-    for(int32_t i=x1; i<=x2; ++i) {
-        float y=m*(float) (i-x1)+(float) y1;
-        ssd1306_draw_pixel(p, i, (uint32_t) y);
+    for(;;) {
+        if(x1>=0 && y1>=0)
+            ssd1306_draw_pixel(p, x1, y1);
+        if(x1==x2 && y1==y2)
+            break;
+        int32_t e2=2*err;
+        if(e2>=dy) {
+            err+=dy;
+            ++x1;
+        }
+        if(e2<=dx) {
+            err+=dx;
+            y1+=sy;
+        }
     }
 }
 
 void ssd1306_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_clear_pixel(p, x+i, y+j);
+    if(x>=p->width || y>=p->height) return;
+
+    ssd1306_fill_rect(p, x, y, ssd1306_clamp_len(width), ssd1306_clamp_len(height), false);
 }
 
 void ssd1306_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_draw_pixel(p, x+i, y+j);
+    if(x>=p->width || y>=p->height) return;
+
+    ssd1306_fill_rect(p, x, y, ssd1306_clamp_len(width), ssd1306_clamp_len(height), true);
 }
 
 void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    ssd1306_draw_line(p, x, y, x+width, y);
-    ssd1306_draw_line(p, x, y+height, x+width, y+height);
-    ssd1306_draw_line(p, x, y, x, y+height);
-    ssd1306_draw_line(p, x+width, y, x+width, y+height);
+    int32_t w=ssd1306_clamp_len(width), h=ssd1306_clamp_len(height);
+    if(x>=p->width || y>=p->height) return;
+
+    ssd1306_draw_hline(p, x, y, w+1);
+    ssd1306_draw_hline(p, x, y+h, w+1);
+    ssd1306_draw_vline(p, x, y, h+1);
+    ssd1306_draw_vline(p, x+w, y, h+1);
 }
 
-void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
-    if(c<font[3]||c>font[4])
-        return;
+static inline uint64_t ssd1306_scale_byte(uint8_t b, uint32_t scale) {
+    switch(scale) {
+    case 1:
+        return b;
+    case 2:
+        return scale2_tab[b];
+    case 3:
+        return scale3_tab[b];
+    default: {
+        uint64_t r=0, ones=(1ull<<scale)-1;
+        for(uint32_t j=0; b; ++j, b>>=1)
+            if(b&1)
+                r|=ones<<(j*scale);
+        return r;
+    }
+    }
+}
 
+// pixel by pixel, for glyphs too tall for one 64-bit column
+static void ssd1306_draw_char_pixels(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
     uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
     for(uint8_t w=0; w<font[1]; ++w) { // width
         uint32_t pp=(c-font[3])*font[1]*parts_per_line+w*parts_per_line+5;
@@ -188,12 +361,231 @@ void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t
     }
 }
 
+// scaled, unshifted column w of a glyph; bit 0 is the top pixel
+static inline uint64_t ssd1306_glyph_column(const uint8_t *glyph, uint32_t parts_per_line, uint32_t w, uint32_t scale) {
+    uint64_t col=0;
+    glyph+=w*parts_per_line;
+    for(uint32_t lp=0; lp<parts_per_line; ++lp)
+        col|=ssd1306_scale_byte(glyph[lp], scale)<<(lp*8*scale);
+    return col;
+}
+
+#define GLYPH_NONE 0xFF     // not in the configured character set
+#define GLYPH_PENDING 0xFE  // in the set, not rendered yet
+
+static struct {
+    const uint8_t *font;
+    uint32_t scale;
+    uint32_t cols;          // columns per glyph (font width)
+    uint32_t slots;         // glyphs that fit the budget
+    uint32_t used;
+    uint8_t slot[128];      // char -> slot, GLYPH_NONE or GLYPH_PENDING
+    ssd1306_glyph_cache_stats_t stats;
+} glyph_cache;
+
+#if SSD1306_GLYPH_CACHE_BYTES>0
+static uint64_t glyph_pool[SSD1306_GLYPH_CACHE_BYTES/sizeof(uint64_t)];
+#else
+// no slots, so the pool is never indexed
+static uint64_t *const glyph_pool=NULL;
+#endif
+
+// cached columns of c, rendering them on first use; NULL if c is not cacheable
+static const uint64_t *ssd1306_glyph_cache_get(const uint8_t *font, uint32_t scale, char c) {
+    if(font!=glyph_cache.font || scale!=glyph_cache.scale)
+        return NULL;
+
+    uint8_t uc=(uint8_t)c;
+    uint8_t slot=uc<128?glyph_cache.slot[uc]:GLYPH_NONE;
+    if(slot<GLYPH_PENDING) {
+        ++glyph_cache.stats.hits;
+        return glyph_pool+slot*glyph_cache.cols;
+    }
+
+    ++glyph_cache.stats.misses;
+    if(slot==GLYPH_NONE || glyph_cache.used>=glyph_cache.slots)
+        return NULL;
+
+    slot=glyph_cache.used++;
+    uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
+    const uint8_t *glyph=font+5+(uc-font[3])*font[1]*parts_per_line;
+    uint64_t *cols=glyph_pool+slot*glyph_cache.cols;
+    for(uint32_t w=0; w<glyph_cache.cols; ++w)
+        cols[w]=ssd1306_glyph_column(glyph, parts_per_line, w, scale);
+    glyph_cache.slot[uc]=slot;
+    ++glyph_cache.stats.fills;
+    return cols;
+}
+
+bool ssd1306_glyph_cache_config(const uint8_t *font, uint32_t scale, const char *charset, bool prefill) {
+    memset(&glyph_cache, 0, sizeof(glyph_cache));
+    memset(glyph_cache.slot, GLYPH_NONE, sizeof(glyph_cache.slot));
+    if(font==NULL || scale==0)
+        return true;
+
+    uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
+    if(parts_per_line*8*scale>64 || font[1]==0)
+        return false;
+
+    glyph_cache.cols=font[1];
+    glyph_cache.slots=SSD1306_GLYPH_CACHE_BYTES/(sizeof(uint64_t)*font[1]);
+    if(glyph_cache.slots>GLYPH_PENDING)
+        glyph_cache.slots=GLYPH_PENDING;
+
+    bool fits=true;
+    uint32_t n=0;
+    for(const char *ch=charset; *ch; ++ch) {
+        uint8_t uc=(uint8_t)*ch;
+        if(uc>=128 || uc<font[3] || uc>font[4] || glyph_cache.slot[uc]!=GLYPH_NONE)
+            continue;
+        glyph_cache.slot[uc]=GLYPH_PENDING;
+        if(++n>glyph_cache.slots)
+            fits=false;
+    }
+    glyph_cache.font=font;
+    glyph_cache.scale=scale;
+
+    if(prefill) {
+        for(const char *ch=charset; *ch; ++ch)
+            ssd1306_glyph_cache_get(font, scale, *ch);
+        glyph_cache.stats=(ssd1306_glyph_cache_stats_t) {.fills=glyph_cache.stats.fills};
+    }
+    return fits;
+}
+
+void ssd1306_glyph_cache_get_stats(ssd1306_glyph_cache_stats_t *stats) {
+    *stats=glyph_cache.stats;
+}
+
+void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
+    if(c<font[3]||c>font[4]||scale==0)
+        return;
+
+    uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
+    uint32_t shift=y&7;
+    if(parts_per_line*8*scale+shift>64) {
+        ssd1306_draw_char_pixels(p, x, y, scale, font, c);
+        return;
+    }
+    if(x>=p->width || (y>>3)>=p->pages)
+        return;
+
+    // glyph columns are scaled vertically once, shifted to the page boundary and ORed a page byte at a time
+    uint32_t page0=y>>3;
+    uint32_t npages=(parts_per_line*8*scale+shift+7)>>3;
+    if(page0+npages>p->pages)
+        npages=p->pages-page0;
+    uint32_t x_end=x+font[1]*scale;
+    if(x_end>p->width)
+        x_end=p->width;
+
+    const uint64_t *cached=ssd1306_glyph_cache_get(font, scale, c);
+    const uint8_t *glyph=font+5+(c-font[3])*font[1]*parts_per_line;
+    for(uint32_t w=0; w<font[1]; ++w) {
+        uint64_t col=cached?cached[w]:ssd1306_glyph_column(glyph, parts_per_line, w, scale);
+        if(!col)
+            continue;
+        col<<=shift;
+
+        for(uint32_t xc=x+w*scale; xc<x+(w+1)*scale && xc<x_end; ++xc) {
+            uint8_t *dst=p->buffer+page0*p->width+xc;
+            uint64_t v=col;
+            for(uint32_t pg=0; pg<npages; ++pg, dst+=p->width, v>>=8)
+                *dst|=(uint8_t)v;
+        }
+    }
+
+    for(uint32_t pg=page0; pg<page0+npages; ++pg) {
+        ssd1306_mark(p, x, pg);
+        ssd1306_mark(p, x_end-1, pg);
+    }
+}
+
 void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s) {
     for(int32_t x_n=x; *s; x_n+=(font[1]+font[2])*scale) {
         ssd1306_draw_char_with_font(p, x_n, y, scale, font, *(s++));
     }
 }
 
+// RLE glyphs are stored page by page; unpack into columns of pages bytes
+static void ssd1306_rle_unpack(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t pages) {
+    uint32_t n=width*pages, col=0, pg=0;
+    for(uint32_t i=0; i<n;) {
+        uint8_t ctl=*src++;
+        uint32_t len=(ctl&0x7F)+1;
+        bool run=ctl&0x80;
+        for(uint32_t k=0; k<len && i<n; ++k, ++i) {
+            dst[col*pages+pg]=run?*src:src[k];
+            if(++col==width) {
+                col=0;
+                ++pg;
+            }
+        }
+        src+=run?1:len;
+    }
+}
+
+void ssd1306_draw_char_pfont(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_pfont_t *font, char c) {
+    uint8_t uc=(uint8_t) c;
+    if(uc<font->first || uc>font->last)
+        return;
+
+    const uint8_t *src;
+    uint32_t width;
+    if(font->glyphs) {
+        const ssd1306_pfont_glyph_t *g=&font->glyphs[uc-font->first];
+        src=font->data+g->offset;
+        width=g->width;
+        x+=g->x;
+    } else {
+        width=font->width;
+        src=font->data+(uc-font->first)*width*font->pages;
+    }
+    if(!width || x>=p->width || (y>>3)>=p->pages)
+        return;
+
+    uint8_t unpacked[SSD1306_PFONT_MAX_GLYPH];
+    if(font->flags&SSD1306_PFONT_RLE) {
+        uint32_t n=width*font->pages;
+        if(n>sizeof(unpacked))
+            return;
+        ssd1306_rle_unpack(src, unpacked, width, font->pages);
+        src=unpacked;
+    }
+
+    // column bytes are already page-aligned; only a y offset inside the page splits them
+    uint32_t page0=y>>3, shift=y&7;
+    uint32_t x_end=x+width;
+    if(x_end>p->width)
+        x_end=p->width;
+
+    for(uint32_t xc=x; xc<x_end; ++xc, src+=font->pages) {
+        uint8_t *dst=p->buffer+page0*p->width+xc;
+        for(uint32_t k=0; k<font->pages; ++k) {
+            uint8_t b=src[k];
+            if(!b)
+                continue;
+            if(page0+k<p->pages)
+                dst[k*p->width]|=b<<shift;
+            if(shift && page0+k+1<p->pages)
+                dst[(k+1)*p->width]|=b>>(8-shift);
+        }
+    }
+
+    uint32_t page_end=page0+font->pages+(shift?1:0);
+    if(page_end>p->pages)
+        page_end=p->pages;
+    for(uint32_t pg=page0; pg<page_end; ++pg) {
+        ssd1306_mark(p, x, pg);
+        ssd1306_mark(p, x_end-1, pg);
+    }
+}
+
+void ssd1306_draw_string_pfont(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_pfont_t *font, const char *s) {
+    for(uint32_t x_n=x; *s; x_n+=font->advance)
+        ssd1306_draw_char_pfont(p, x_n, y, font, *(s++));
+}
+
 void ssd1306_draw_char(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, char c) {
     ssd1306_draw_char_with_font(p, x, y, scale, font_8x5, c);
 }
@@ -265,19 +657,188 @@ inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long
     ssd1306_bmp_show_image_with_offset(p, data, size, 0, 0);
 }
 
-void ssd1306_show(ssd1306_t *p) {
-    uint8_t payload[]= {SET_COL_ADDR, 0, p->width-1, SET_PAGE_ADDR, 0, p->pages-1};
-    if(p->width==64) {
-        payload[1]+=32;
-        payload[2]+=32;
+// page rows of the image go to the buffer as whole bytes; a y offset inside the page
+// splits each source byte over two pages
+static void ssd1306_blit_image(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_image_t *img, bool copy) {
+    if(x>=p->width || y>=p->height || !img->width || !img->height)
+        return;
+
+    uint32_t width=img->width;
+    if(x+width>p->width)
+        width=p->width-x;
+
+    uint32_t page0=y>>3, shift=y&7;
+    uint32_t src_pages=(img->height+7)>>3;
+
+    for(uint32_t sp=0; sp<src_pages && page0+sp<p->pages; ++sp) {
+        const uint8_t *src=img->data+sp*img->width;
+        uint8_t *dst=p->buffer+(page0+sp)*p->width+x;
+        uint32_t rows=img->height-(sp<<3);
+        uint8_t valid=rows>=8?0xFF:(uint8_t) (0xFFu>>(8-rows));
+
+        if(!shift) {
+            if(!copy)
+                for(uint32_t i=0; i<width; ++i)
+                    dst[i]|=src[i];
+            else if(valid==0xFF)
+                memcpy(dst, src, width);
+            else
+                for(uint32_t i=0; i<width; ++i)
+                    dst[i]=(dst[i]&~valid)|(src[i]&valid);
+        } else {
+            uint8_t *next=page0+sp+1<p->pages?dst+p->width:NULL;
+            uint8_t lo=(uint8_t) (valid<<shift), hi=(uint8_t) (valid>>(8-shift));
+            for(uint32_t i=0; i<width; ++i) {
+                uint8_t b=src[i]&valid;
+                if(copy) {
+                    dst[i]=(dst[i]&~lo)|(uint8_t) (b<<shift);
+                    if(next && hi)
+                        next[i]=(next[i]&~hi)|(b>>(8-shift));
+                } else {
+                    dst[i]|=b<<shift;
+                    if(next)
+                        next[i]|=b>>(8-shift);
+                }
+            }
+            if(next && hi) {
+                ssd1306_mark(p, x, page0+sp+1);
+                ssd1306_mark(p, x+width-1, page0+sp+1);
+            }
+        }
+        ssd1306_mark(p, x, page0+sp);
+        ssd1306_mark(p, x+width-1, page0+sp);
+    }
+}
+
+void ssd1306_draw_image(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_image_t *img) {
+    ssd1306_blit_image(p, x, y, img, false);
+}
+
+void ssd1306_copy_image(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_image_t *img) {
+    ssd1306_blit_image(p, x, y, img, true);
+}
+
+// pack columns lo..hi of pages pg..pg+n-1 as one window and remember them as sent
+static uint8_t *ssd1306_add_window(ssd1306_t *p, uint8_t *d, uint32_t pg, uint32_t n, uint32_t lo, uint32_t hi) {
+    uint8_t off=p->width==64?32:0;
+    uint32_t w=hi-lo+1;
+
+    ssd1306_cmdlist_t l;
+    ssd1306_cmdlist_init(&l, d, SSD1306_WINDOW_HDR-1);
+    ssd1306_cmdlist_add(&l, SET_COL_ADDR);
+    ssd1306_cmdlist_add(&l, lo+off);
+    ssd1306_cmdlist_add(&l, hi+off);
+    ssd1306_cmdlist_add(&l, SET_PAGE_ADDR);
+    ssd1306_cmdlist_add(&l, pg);
+    ssd1306_cmdlist_add(&l, pg+n-1);
+    d+=l.len;
+
+    uint8_t *data=d;
+    *d++=0x40;
+    for(uint32_t i=pg; i<pg+n; ++i) {
+        memcpy(d, p->buffer+i*p->width+lo, w);
+        memcpy(p->sent+i*p->width+lo, d, w);
+        d+=w;
+    }
+
+    ssd1306_seg_t *s=&p->seg[2*p->windows++];
+    s[0]=(ssd1306_seg_t) {.buf=l.buf, .len=l.len};
+    s[1]=(ssd1306_seg_t) {.buf=data, .len=d-data};
+    p->frame_bytes+=p->bus->window_cost+n*w;
+    return d;
+}
+
+// narrow the dirty span of a page to the columns that differ from display RAM
+static bool ssd1306_trim(ssd1306_t *p, uint32_t pg, uint32_t *lo, uint32_t *hi) {
+    const uint8_t *b=p->buffer+pg*p->width;
+    const uint8_t *s=p->sent+pg*p->width;
+    int32_t l=p->dirty_lo[pg], h=p->dirty_hi[pg];
+
+    while(l<=h && b[l]==s[l]) ++l;
+    while(h>=l && b[h]==s[h]) --h;
+    if(l>h)
+        return false;
+
+    *lo=l;
+    *hi=h;
+    return true;
+}
+
+// pack every changed region into the front buffer
+static void ssd1306_pack(ssd1306_t *p) {
+    uint8_t *d=p->front;
+
+    if(!p->sent_valid) {
+        p->sent_valid=true;
+        ssd1306_add_window(p, d, 0, p->pages, 0, p->width-1);
+        for(uint32_t i=0; i<p->pages; ++i)
+            ssd1306_mark_clean(p, i);
+        return;
+    }
+
+    // open window: pages wpg..wpg+npg-1, columns wlo..whi
+    uint32_t wpg=0, npg=0, wlo=0, whi=0;
+    for(uint32_t pg=0; pg<p->pages; ++pg) {
+        uint32_t lo=0, hi=0;
+        bool dirty=ssd1306_trim(p, pg, &lo, &hi);
+        ssd1306_mark_clean(p, pg);
+
+        if(dirty && npg) {
+            uint32_t ulo=lo<wlo?lo:wlo, uhi=hi>whi?hi:whi;
+            uint32_t merged=(npg+1)*(uhi-ulo+1);
+            uint32_t separate=npg*(whi-wlo+1)+(hi-lo+1)+p->bus->window_cost;
+            if(merged<=separate) {
+                wlo=ulo;
+                whi=uhi;
+                ++npg;
+                continue;
+            }
+        }
+
+        if(npg)
+            d=ssd1306_add_window(p, d, wpg, npg, wlo, whi);
+        npg=0;
+
+        if(dirty) {
+            wpg=pg;
+            npg=1;
+            wlo=lo;
+            whi=hi;
+        }
     }
 
-    for(size_t i=0; i<sizeof(payload); ++i)
-        ssd1306_write(p, payload[i]);
+    if(npg)
+        ssd1306_add_window(p, d, wpg, npg, wlo, whi);
+}
+
+bool ssd1306_show_busy(ssd1306_t *p) {
+    return p->windows && p->bus->busy(p);
+}
+
+bool ssd1306_show_async(ssd1306_t *p) {
+    if(ssd1306_show_busy(p))
+        return false;
+
+    p->windows=0;
+    p->frame_bytes=0;
+    ssd1306_pack(p);
 
-    *(p->buffer-1)=0x40;
+    // a failed window leaves display RAM unknown, the backend clears sent_valid
+    if(p->windows)
+        p->bus->submit(p);
+    return true;
+}
 
-    fancy_write(p->i2c_i, p->address, p->buffer-1, p->bufsize+1, "ssd1306_show");
+bool ssd1306_show_wait(ssd1306_t *p) {
+    return p->bus->wait(p);
 }
 
+void ssd1306_show(ssd1306_t *p) {
+    ssd1306_show_wait(p);
+    ssd1306_show_async(p);
+    ssd1306_show_wait(p);
+}
 
+inline void ssd1306_invalidate(ssd1306_t *p) {
+    p->sent_valid=false;
+}
@@ -2,6 +2,8 @@
 #define _inc_ssd1306
 #include <pico/stdlib.h>
 #include <hardware/i2c.h>
+#include <hardware/spi.h>
+#include "i2c_async.h"
 
 /**
 *	@brief defines commands used in ssd1306
@@ -27,17 +29,125 @@ typedef enum {
 } ssd1306_command_t;
 
 /**
-*	@brief holds the configuration
+*	@brief command list: any sequence of commands sent after one control byte in a single transaction
+*/
+typedef struct {
+    uint8_t *buf;		/**< storage, buf[0] holds the control byte */
+    size_t len;			/**< bytes used, control byte included */
+    size_t size;		/**< size of storage */
+    bool overflow;		/**< a byte did not fit, the list will not be sent */
+} ssd1306_cmdlist_t;
+
+/**
+*	@brief RAM reserved for pre-rendered glyphs (8 bytes per glyph column)
+
+	0, the default, leaves the cache out; ssd1306_glyph_cache_config then
+	caches nothing. The frequency screen draws page-aligned fonts and does not
+	need it; build with e.g. -DSSD1306_GLYPH_CACHE_BYTES=1024 to use it.
+*/
+#ifndef SSD1306_GLYPH_CACHE_BYTES
+#define SSD1306_GLYPH_CACHE_BYTES 0
+#endif
+
+/**
+*	@brief glyph cache counters, only lookups with the configured font and scale count
+*/
+typedef struct {
+    uint32_t hits;		/**< glyph drawn from the cache */
+    uint32_t misses;	/**< glyph rendered from the font (including the first use of a cached glyph) */
+    uint32_t fills;		/**< glyphs rendered into the cache */
+} ssd1306_glyph_cache_stats_t;
+
+/**
+*	@brief glyph of a page-aligned font (see tools/fontconv.py)
+*/
+typedef struct {
+    uint16_t offset;	/**< start of the glyph in data */
+    uint8_t x;			/**< blank columns skipped on the left */
+    uint8_t width;		/**< stored columns, 0 for a blank glyph */
+} ssd1306_pfont_glyph_t;
+
+/**
+*	@brief glyph data is stored page by page and run-length coded: 0x80|(n-1),b repeats b n times, n-1,b0..bn-1 are n literal bytes
+*/
+#define SSD1306_PFONT_RLE 0x01
+
+/**
+*	@brief largest RLE glyph (columns * pages) that can be drawn
+*/
+#ifndef SSD1306_PFONT_MAX_GLYPH
+#define SSD1306_PFONT_MAX_GLYPH 256
+#endif
+
+/**
+*	@brief page-aligned, pre-scaled font generated from the column-wise fonts at build time
+*/
+typedef struct {
+    uint8_t height;		/**< glyph height in pixels (scale applied) */
+    uint8_t pages;		/**< bytes per column */
+    uint8_t advance;	/**< distance between characters */
+    uint8_t first;		/**< first ascii char */
+    uint8_t last;		/**< last ascii char */
+    uint8_t flags;		/**< SSD1306_PFONT_RLE */
+    uint8_t width;		/**< columns of every glyph when glyphs is NULL */
+    uint16_t max_glyph;	/**< largest glyph in bytes, unpacked */
+    const ssd1306_pfont_glyph_t *glyphs;	/**< last-first+1 entries, NULL for fixed width glyphs */
+    const uint8_t *data;	/**< columns of all glyphs, top page first */
+} ssd1306_pfont_t;
+
+/**
+*	@brief page-native monochrome image generated from a BMP at build time (see tools/bmpconv.py)
 */
 typedef struct {
+    uint8_t width;		/**< width in pixels */
+    uint8_t height;		/**< height in pixels */
+    const uint8_t *data;	/**< ceil(height/8) pages of width bytes, LSB on top */
+} ssd1306_image_t;
+
+/**
+*	@brief largest supported number of pages (64 pixel high display)
+*/
+#define SSD1306_MAX_PAGES 8
+
+/**
+*	@brief part of a frame, framed as on I2C: control byte (0x00 commands, 0x40 data) first
+*/
+typedef struct {
+    const uint8_t *buf;	/**< control byte and payload */
+    uint16_t len;		/**< bytes in buf */
+} ssd1306_seg_t;
+
+/**
+*	@brief transport backend (I2C or SPI), chosen by the init function; see ssd1306_bus.h
+*/
+typedef struct ssd1306_transport ssd1306_transport_t;
+
+/**
+*	@brief holds the configuration
+*/
+typedef struct ssd1306 {
     uint8_t width; 		/**< width of display */
     uint8_t height; 	/**< height of display */
     uint8_t pages;		/**< stores pages of display (calculated on initialization*/
+    const ssd1306_transport_t *bus;	/**< backend moving command lists and data to the display */
     uint8_t address; 	/**< i2c address of display*/
     i2c_inst_t *i2c_i; 	/**< i2c connection instance */
+    spi_inst_t *spi_i;	/**< spi connection instance */
+    uint8_t dc_pin;		/**< spi: D/C# GPIO */
+    uint8_t cs_pin;		/**< spi: CS# GPIO */
+    uint8_t rst_pin;	/**< spi: RES# GPIO */
     bool external_vcc; 	/**< whether display uses external vcc */ 
     uint8_t *buffer;	/**< display buffer */
     size_t bufsize;		/**< buffer size */
+    uint8_t *sent;		/**< copy of display RAM as last sent, used to trim dirty spans */
+    uint8_t *front;		/**< front buffer: packed windows of the frame on its way to the display */
+    bool sent_valid;	/**< false until display RAM content is known */
+    uint8_t dirty_lo[SSD1306_MAX_PAGES];	/**< first dirty column per page (> dirty_hi if clean) */
+    uint8_t dirty_hi[SSD1306_MAX_PAGES];	/**< last dirty column per page */
+    uint32_t frame_bytes;	/**< bytes on the bus of the last frame (on I2C address and control bytes included) */
+    ssd1306_seg_t seg[2*SSD1306_MAX_PAGES];	/**< command list and data of every window */
+    i2c_async_txn_t txn[2*SSD1306_MAX_PAGES];	/**< i2c: transactions of the segments */
+    uint8_t windows;	/**< windows of the last frame */
 } ssd1306_t;
 
 /**
@@ -47,7 +157,7 @@ typedef struct {
 *	@param[in] width : width of display
 *	@param[in] height : heigth of display
 *	@param[in] address : i2c address of display
-*	@param[in] i2c_instance : instance of i2c connection
+*	@param[in] i2c_instance : instance of i2c connection, already attached to i2c_async
 *	
 * 	@return bool.
 *	@retval true for Success
@@ -55,6 +165,64 @@ typedef struct {
 */
 bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance);
 
+/**
+*	@brief initialize display wired to 4-wire SPI
+*
+*	The SPI instance must already run (spi_init() and the SCK/MOSI pin
+*	functions); the format is set to mode 0 here, the control GPIOs are
+*	set up and the display is reset through RES#.
+*
+*	@param[in] p : pointer to instance of ssd1306_t
+*	@param[in] width : width of display
+*	@param[in] height : heigth of display
+*	@param[in] spi_instance : instance of spi connection
+*	@param[in] dc_pin : GPIO driving D/C#
+*	@param[in] cs_pin : GPIO driving CS#
+*	@param[in] rst_pin : GPIO driving RES#
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if initialization failed
+*/
+bool ssd1306_init_spi(ssd1306_t *p, uint16_t width, uint16_t height, spi_inst_t *spi_instance, uint8_t dc_pin, uint8_t cs_pin, uint8_t rst_pin);
+
+/**
+*	@brief start an empty command list in caller provided storage
+
+*	@param[out] l : command list
+*	@param[in] storage : room for the control byte and the commands
+*	@param[in] size : size of storage in bytes
+*/
+void ssd1306_cmdlist_init(ssd1306_cmdlist_t *l, uint8_t *storage, size_t size);
+
+/**
+*	@brief append a command or command argument
+
+*	@param[in] l : command list
+*	@param[in] b : command or argument byte
+*/
+void ssd1306_cmdlist_add(ssd1306_cmdlist_t *l, uint8_t b);
+
+/**
+*	@brief append several command and argument bytes
+
+*	@param[in] l : command list
+*	@param[in] b : bytes
+*	@param[in] n : number of bytes
+*/
+void ssd1306_cmdlist_add_n(ssd1306_cmdlist_t *l, const uint8_t *b, size_t n);
+
+/**
+*	@brief send the whole list as one I2C transaction and wait for it
+
+*	@param[in] p : instance of display
+*	@param[in] l : command list
+*
+* 	@return bool.
+*	@retval false if the list overflowed or was not acknowledged
+*/
+bool ssd1306_cmdlist_send(ssd1306_t *p, const ssd1306_cmdlist_t *l);
+
 /**
 *	@brief deinitialize display
 *
@@ -100,11 +268,60 @@ void ssd1306_invert(ssd1306_t *p, uint8_t inv);
 /**
 	@brief display buffer, should be called on change
 
+	Only columns changed since the previous call are sent: draw calls mark
+	dirty column spans per page, the spans are trimmed against the copy of
+	display RAM and transmitted through SET_COL_ADDR/SET_PAGE_ADDR windows.
+	Adjacent dirty pages share one window when that is cheaper.
+
 	@param[in] p : instance of display
 
 */
 void ssd1306_show(ssd1306_t *p);
 
+/**
+	@brief start sending the frame without waiting for the bus
+
+	Changed windows are packed into the front buffer and handed to the
+	transport: on I2C they are queued for DMA and drawing into buffer may
+	continue right away, on SPI they are written before returning. Returns false without
+	touching anything while the previous frame is still on its way; the
+	changes stay marked and go out with the next call.
+
+	@param[in] p : instance of display
+
+	@return bool.
+	@retval true if the frame was queued (or nothing had changed)
+	@retval false if the previous frame is still in flight
+*/
+bool ssd1306_show_async(ssd1306_t *p);
+
+/**
+	@brief whether the last frame is still being transferred
+
+	@param[in] p : instance of display
+*/
+bool ssd1306_show_busy(ssd1306_t *p);
+
+/**
+	@brief wait until the last frame has been transferred
+
+	@param[in] p : instance of display
+
+	@return bool.
+	@retval false if any part of the frame was not acknowledged
+*/
+bool ssd1306_show_wait(ssd1306_t *p);
+
+/**
+	@brief forget what display RAM holds, next ssd1306_show sends the full frame
+
+	Needed after writing to buffer directly or after the display lost its RAM.
+
+	@param[in] p : instance of display
+
+*/
+void ssd1306_invalidate(ssd1306_t *p);
+
 /**
 	@brief clear display buffer
 
@@ -142,6 +359,26 @@ void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y);
 */
 void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
 
+/**
+	@brief draw horizontal line on buffer
+
+	@param[in] p : instance of display
+	@param[in] x : x position of leftmost pixel
+	@param[in] y : y position
+	@param[in] width : length in pixels
+*/
+void ssd1306_draw_hline(ssd1306_t *p, int32_t x, int32_t y, uint32_t width);
+
+/**
+	@brief draw vertical line on buffer
+
+	@param[in] p : instance of display
+	@param[in] x : x position
+	@param[in] y : y position of topmost pixel
+	@param[in] height : length in pixels
+*/
+void ssd1306_draw_vline(ssd1306_t *p, int32_t x, int32_t y, uint32_t height);
+
 /**
 	@brief clear square at given position with given size
 
@@ -195,6 +432,30 @@ void ssd1306_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, const
 */
 void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long size);
 
+/**
+	@brief draw page-native image, set pixels are ORed into the buffer
+
+	Same result as ssd1306_bmp_show_image_with_offset on the source BMP.
+
+	@param[in] p : instance of display
+	@param[in] x : x position of left edge
+	@param[in] y : y position of top edge
+	@param[in] img : generated image
+*/
+void ssd1306_draw_image(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_image_t *img);
+
+/**
+	@brief copy page-native image, the covered area is replaced (clear pixels included)
+
+	With y a multiple of 8 every page row is a single memcpy.
+
+	@param[in] p : instance of display
+	@param[in] x : x position of left edge
+	@param[in] y : y position of top edge
+	@param[in] img : generated image
+*/
+void ssd1306_copy_image(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_image_t *img);
+
 /**
 	@brief draw char with given font
 
@@ -207,6 +468,52 @@ void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long size);
 */
 void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c);
 
+/**
+	@brief choose which glyphs ssd1306_draw_char_with_font keeps pre-rendered
+
+	Glyphs of charset in the given font and scale are stored scaled and
+	page-aligned, on first use or right away with prefill. Calling again
+	replaces the whole cache; font==NULL disables it.
+
+	@param[in] font : pointer to font
+	@param[in] scale : scale the glyphs are drawn with
+	@param[in] charset : characters to cache
+	@param[in] prefill : render all of charset now
+
+	@return bool.
+	@retval false if not all of charset fits SSD1306_GLYPH_CACHE_BYTES (the rest is drawn uncached)
+*/
+bool ssd1306_glyph_cache_config(const uint8_t *font, uint32_t scale, const char *charset, bool prefill);
+
+/**
+	@brief read glyph cache counters
+
+	@param[out] stats : counters since ssd1306_glyph_cache_config
+*/
+void ssd1306_glyph_cache_get_stats(ssd1306_glyph_cache_stats_t *stats);
+
+/**
+	@brief draw char with a page-aligned font
+
+	@param[in] p : instance of display
+	@param[in] x : x starting position of char
+	@param[in] y : y starting position of char
+	@param[in] font : generated font
+	@param[in] c : character to draw
+*/
+void ssd1306_draw_char_pfont(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_pfont_t *font, char c);
+
+/**
+	@brief draw string with a page-aligned font
+
+	@param[in] p : instance of display
+	@param[in] x : x starting position of text
+	@param[in] y : y starting position of text
+	@param[in] font : generated font
+	@param[in] s : text to draw
+*/
+void ssd1306_draw_string_pfont(ssd1306_t *p, uint32_t x, uint32_t y, const ssd1306_pfont_t *font, const char *s);
+
 /**
 	@brief draw char with builtin font
 
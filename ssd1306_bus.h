@@ -0,0 +1,29 @@
+#ifndef _inc_ssd1306_bus
+#define _inc_ssd1306_bus
+
+#include "ssd1306.h"
+
+/**
+*	@brief transport backend of the driver
+*
+*	The core packs everything framed as on I2C (see ssd1306_seg_t); a
+*	backend without control bytes (SPI) takes D/C# from bit 6 of the first
+*	byte and sends the rest.
+*/
+struct ssd1306_transport {
+    bool (*write)(ssd1306_t *p, const uint8_t *buf, size_t len);	/**< send one segment and wait for it */
+    bool (*submit)(ssd1306_t *p);	/**< start sending p->seg[0 .. 2*p->windows-1] */
+    bool (*busy)(ssd1306_t *p);		/**< submitted frame still in flight (windows > 0) */
+    bool (*wait)(ssd1306_t *p);		/**< wait for the submitted frame, false if any part failed */
+    uint8_t window_cost;			/**< bytes on the bus per window besides the data */
+};
+
+extern const ssd1306_transport_t ssd1306_i2c_transport;
+extern const ssd1306_transport_t ssd1306_spi_transport;
+
+/**
+*	@brief buffers and controller setup shared by the init functions, p->bus must be set
+*/
+bool ssd1306_init_core(ssd1306_t *p, uint16_t width, uint16_t height);
+
+#endif
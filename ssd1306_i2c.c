@@ -0,0 +1,62 @@
+#include <pico/stdlib.h>
+#include <hardware/i2c.h>
+
+#include "ssd1306.h"
+#include "ssd1306_bus.h"
+
+// bus bytes of a window: address + control + six commands, then address + control before the data
+#define SSD1306_I2C_WINDOW_COST (8+2)
+
+static bool ssd1306_i2c_write(ssd1306_t *p, const uint8_t *buf, size_t len) {
+    // the bus belongs to i2c_async, so even blocking writes go through its queue
+    i2c_async_txn_t txn= {.addr=p->address, .tx=buf, .tx_len=len};
+    return i2c_async_transfer_blocking(p->i2c_i, &txn);
+}
+
+static void ssd1306_i2c_window_done(i2c_async_txn_t *t) {
+    // display RAM no longer matches sent, resend everything with the next frame
+    if(t->status==I2C_ASYNC_ERROR)
+        ((ssd1306_t *)t->user)->sent_valid=false;
+}
+
+static bool ssd1306_i2c_submit(ssd1306_t *p) {
+    bool ok=true;
+    for(uint32_t i=0; i<2u*p->windows; ++i) {
+        p->txn[i]=(i2c_async_txn_t) {.addr=p->address, .tx=p->seg[i].buf, .tx_len=p->seg[i].len,
+                                     .callback=ssd1306_i2c_window_done, .user=p};
+        if(!i2c_async_submit(p->i2c_i, &p->txn[i])) {
+            p->txn[i].status=I2C_ASYNC_ERROR;
+            p->sent_valid=false;
+            ok=false;
+        }
+    }
+    return ok;
+}
+
+static bool ssd1306_i2c_busy(ssd1306_t *p) {
+    // one priority, one queue: the last transaction finishes last
+    return !i2c_async_finished(&p->txn[2*p->windows-1]);
+}
+
+static bool ssd1306_i2c_wait(ssd1306_t *p) {
+    bool ok=true;
+    // i2c_async_wait aborts a window stuck on the wire
+    for(uint32_t i=0; i<2u*p->windows; ++i)
+        ok=i2c_async_wait(&p->txn[i]) && ok;
+    return ok;
+}
+
+const ssd1306_transport_t ssd1306_i2c_transport= {
+    .write=ssd1306_i2c_write,
+    .submit=ssd1306_i2c_submit,
+    .busy=ssd1306_i2c_busy,
+    .wait=ssd1306_i2c_wait,
+    .window_cost=SSD1306_I2C_WINDOW_COST,
+};
+
+bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance) {
+    p->bus=&ssd1306_i2c_transport;
+    p->address=address;
+    p->i2c_i=i2c_instance;
+    return ssd1306_init_core(p, width, height);
+}
@@ -3,24 +3,39 @@
 #include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/spi.h"
 
 #include "ssd1306.h"
-#include "image.h"
+#include "images_pf.h"
 #include "main.h"
+#include "i2c_async.h"
 #include "ssd1306_setup.h"
 
 const uint8_t num_chars_per_disp[]={7,7,7,5};
 const uint8_t *fonts[4]= {};
 ssd1306_t disp;
 
+#if !OLED_SPI
+// DMA command words for I2C1: one per byte of the largest transfer (full frame + control byte)
+static uint16_t i2c1_cmd[128*8+1];
+#endif
+
 void setup(void) {
+    disp.external_vcc=false;
+#if OLED_SPI
+    spi_init(OLED_SPI_PORT, OLED_SPI_BAUD);
+    gpio_set_function(OLED_SPI_SCK, GPIO_FUNC_SPI);
+    gpio_set_function(OLED_SPI_MOSI, GPIO_FUNC_SPI);
+    ssd1306_init_spi(&disp, 128, 64, OLED_SPI_PORT, OLED_SPI_DC, OLED_SPI_CS, OLED_SPI_RST);
+#else
     i2c_init(I2C1_PORT, 400*1000);
     gpio_set_function(I2C1_SDA, GPIO_FUNC_I2C);
     gpio_set_function(I2C1_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C1_SDA);
     gpio_pull_up(I2C1_SCL);
-    disp.external_vcc=false;
+    i2c_async_init(I2C1_PORT, i2c1_cmd, count_of(i2c1_cmd));
     ssd1306_init(&disp, 128, 64, 0x3C, I2C1_PORT);
+#endif
     ssd1306_clear(&disp);
 
 }
@@ -79,7 +94,7 @@ void test(void){
             }
         }
 
-        ssd1306_bmp_show_image(&disp, image_data, image_size);
+        ssd1306_copy_image(&disp, 0, 0, &splash_image);
         ssd1306_show(&disp);
         sleep_ms(2000);
     }
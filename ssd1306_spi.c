@@ -0,0 +1,70 @@
+#include <pico/stdlib.h>
+#include <hardware/spi.h>
+#include <hardware/gpio.h>
+
+#include "ssd1306.h"
+#include "ssd1306_bus.h"
+
+// bus bytes of a window: six commands; D/C# and CS# are wires, not bytes
+#define SSD1306_SPI_WINDOW_COST 6
+
+static bool ssd1306_spi_write(ssd1306_t *p, const uint8_t *buf, size_t len) {
+    if(len<2)
+        return false;
+
+    // control byte: D/C# is bit 6, the byte itself does not go on the wire
+    gpio_put(p->dc_pin, buf[0]&0x40);
+    gpio_put(p->cs_pin, 0);
+    spi_write_blocking(p->spi_i, buf+1, len-1);
+    gpio_put(p->cs_pin, 1);
+    return true;
+}
+
+// at 8-10 MHz a full frame takes about 1 ms, so frames are written right away
+static bool ssd1306_spi_submit(ssd1306_t *p) {
+    for(uint32_t i=0; i<2u*p->windows; ++i)
+        ssd1306_spi_write(p, p->seg[i].buf, p->seg[i].len);
+    return true;
+}
+
+static bool ssd1306_spi_busy(ssd1306_t *p) {
+    return false;
+}
+
+static bool ssd1306_spi_wait(ssd1306_t *p) {
+    return true;
+}
+
+const ssd1306_transport_t ssd1306_spi_transport= {
+    .write=ssd1306_spi_write,
+    .submit=ssd1306_spi_submit,
+    .busy=ssd1306_spi_busy,
+    .wait=ssd1306_spi_wait,
+    .window_cost=SSD1306_SPI_WINDOW_COST,
+};
+
+bool ssd1306_init_spi(ssd1306_t *p, uint16_t width, uint16_t height, spi_inst_t *spi_instance, uint8_t dc_pin, uint8_t cs_pin, uint8_t rst_pin) {
+    p->bus=&ssd1306_spi_transport;
+    p->spi_i=spi_instance;
+    p->dc_pin=dc_pin;
+    p->cs_pin=cs_pin;
+    p->rst_pin=rst_pin;
+
+    // SSD1306 samples on the rising edge of SCLK: mode 0
+    spi_set_format(spi_instance, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+
+    const uint8_t pins[]= {dc_pin, cs_pin, rst_pin};
+    for(uint32_t i=0; i<count_of(pins); ++i) {
+        gpio_init(pins[i]);
+        gpio_set_dir(pins[i], GPIO_OUT);
+        gpio_put(pins[i], 1);
+    }
+
+    // RES# low for at least 3 us, then wait for the controller to come up
+    gpio_put(rst_pin, 0);
+    sleep_us(10);
+    gpio_put(rst_pin, 1);
+    sleep_ms(1);
+
+    return ssd1306_init_core(p, width, height);
+}
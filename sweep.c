@@ -0,0 +1,187 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "Si5351.h"
+#include "sweep.h"
+
+/* Tablica obrazów rejestrów liczona przed startem */
+static si5351_clk0_regs_t g_table[SWEEP_MAX_STEPS];
+static uint32_t g_freq[SWEEP_MAX_STEPS];
+static uint32_t g_count = 0;
+static sweep_config_t g_cfg;
+
+/* Stan przemiatania (zmieniany w przerwaniu timera) */
+static repeating_timer_t g_timer;
+static volatile bool g_running = false;
+static uint32_t g_idx;
+static int32_t g_dir;
+static bool g_sync_high;
+static uint64_t g_t0;
+static uint64_t g_last;
+static sweep_stats_t g_stats;
+
+static bool push_point(uint32_t f) {
+    if (g_count > 0 && g_freq[g_count - 1] == f) return true; // zaokrąglenie dało ten sam punkt
+    if (g_count >= SWEEP_MAX_STEPS) return false;
+    g_freq[g_count++] = f;
+    return true;
+}
+
+/* false => punktów więcej niż SWEEP_MAX_STEPS; przemiatanie nie dochodziłoby do stop_hz */
+static bool build_points(const sweep_config_t *cfg) {
+    bool up = cfg->stop_hz >= cfg->start_hz;
+    uint32_t span = up ? cfg->stop_hz - cfg->start_hz : cfg->start_hz - cfg->stop_hz;
+
+    if (cfg->spacing == SWEEP_LINEAR) {
+        for (uint32_t off = 0; off < span; off += cfg->step_hz) {
+            if (!push_point(up ? cfg->start_hz + off : cfg->start_hz - off)) return false;
+            if (span - off <= cfg->step_hz) break;
+        }
+    } else {
+        /* f_k = start * 10^(k / ppd); liczone raz, poza przerwaniem */
+        double step = log(10.0) / cfg->points_per_decade;
+        double ln_start = log((double)cfg->start_hz);
+        double ln_stop = log((double)cfg->stop_hz);
+        for (uint32_t k = 0; ; ++k) {
+            double ln_f = up ? ln_start + k * step : ln_start - k * step;
+            if (up ? ln_f >= ln_stop : ln_f <= ln_stop) break;
+            if (!push_point((uint32_t)(exp(ln_f) + 0.5))) return false;
+        }
+    }
+    return push_point(cfg->stop_hz);
+}
+
+uint32_t sweep_prepare(const sweep_config_t *cfg) {
+    if (g_running) return 0;
+    g_count = 0;
+
+    if (cfg->start_hz < 8000u || cfg->start_hz > 160000000u) return 0;
+    if (cfg->stop_hz < 8000u || cfg->stop_hz > 160000000u) return 0;
+    if (cfg->dwell_us == 0) return 0;
+    if (cfg->spacing == SWEEP_LINEAR && cfg->step_hz == 0) return 0;
+    if (cfg->spacing == SWEEP_LOG && cfg->points_per_decade == 0) return 0;
+
+    g_cfg = *cfg;
+    if (!build_points(cfg)) { g_count = 0; return 0; }
+
+    /* Wspólne VCO z planu najwyższej częstotliwości – pozostałe punkty zwykle zmieniają tylko MS0 */
+    si5351_plan_t plan;
+    uint32_t fmax = cfg->start_hz > cfg->stop_hz ? cfg->start_hz : cfg->stop_hz;
+    if (!si5351_plan(fmax, &plan)) { g_count = 0; return 0; }
+    si5351_frac_t pll = plan.pll;
+
+    for (uint32_t i = 0; i < g_count; ++i) {
+        if (!si5351_plan_from_vco(&pll, g_freq[i], &plan) && !si5351_plan(g_freq[i], &plan)) {
+            g_count = 0;
+            return 0;
+        }
+        si5351_clk0_build(&plan, &g_table[i]);
+    }
+    return g_count;
+}
+
+static void apply_step(void) {
+    bool pll_reset = false;
+    if (!si5351_clk0_apply(&g_table[g_idx], g_freq[g_idx], &pll_reset)) g_stats.i2c_errors++;
+    if (pll_reset) g_stats.pll_resets++;
+    g_stats.steps++;
+}
+
+/* Impuls synchronizacji: stan wysoki przez pierwszy krok każdego przebiegu */
+static void sync_pulse(void) {
+    if (g_cfg.sync_gpio < 0) return;
+    bool high = (g_idx == 0);
+    if (high != g_sync_high) {
+        gpio_put((uint)g_cfg.sync_gpio, high);
+        g_sync_high = high;
+    }
+}
+
+/* Następny punkt; false => koniec przemiatania */
+static bool advance(void) {
+    if (g_count == 1) return g_cfg.repeat != SWEEP_ONCE;
+
+    int32_t next = (int32_t)g_idx + g_dir;
+    if (next >= 0 && next < (int32_t)g_count) {
+        g_idx = (uint32_t)next;
+        return true;
+    }
+
+    switch (g_cfg.repeat) {
+    case SWEEP_REPEAT:
+        g_idx = 0;
+        return true;
+    case SWEEP_PINGPONG:
+        g_dir = -g_dir;
+        g_idx = (uint32_t)((int32_t)g_idx + g_dir);
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool sweep_timer_callback(repeating_timer_t *rt) {
+    uint64_t now = time_us_64();
+    uint64_t expected = g_t0 + (uint64_t)g_stats.steps * g_cfg.dwell_us;
+    uint32_t jitter = (uint32_t)(now > expected ? now - expected : expected - now);
+    if (jitter > g_stats.max_jitter_us) g_stats.max_jitter_us = jitter;
+
+    if (!g_running || !advance()) {
+        g_running = false;
+        if (g_cfg.sync_gpio >= 0) gpio_put((uint)g_cfg.sync_gpio, false);
+        return false;
+    }
+
+    sync_pulse();
+    apply_step();
+    g_last = now;
+    return true;
+}
+
+bool sweep_start(void) {
+    if (g_count == 0) return false;
+    sweep_stop();
+
+    g_idx = 0;
+    g_dir = 1;
+    g_stats = (sweep_stats_t){0};
+
+    if (g_cfg.sync_gpio >= 0) {
+        gpio_init((uint)g_cfg.sync_gpio);
+        gpio_set_dir((uint)g_cfg.sync_gpio, GPIO_OUT);
+        gpio_put((uint)g_cfg.sync_gpio, false);
+        g_sync_high = false;
+    }
+
+    g_running = true;
+    g_t0 = g_last = time_us_64();
+    sync_pulse();
+    apply_step();
+
+    /* ujemny okres => odstęp liczony od startu poprzedniego wywołania, bez dryfu */
+    if (!add_repeating_timer_us(-(int64_t)g_cfg.dwell_us, sweep_timer_callback, NULL, &g_timer)) {
+        g_running = false;
+        return false;
+    }
+    return true;
+}
+
+void sweep_stop(void) {
+    if (!g_running) return;
+    g_running = false;
+    cancel_repeating_timer(&g_timer);
+    if (g_cfg.sync_gpio >= 0) gpio_put((uint)g_cfg.sync_gpio, false);
+}
+
+bool sweep_running(void) {
+    return g_running;
+}
+
+void sweep_get_stats(sweep_stats_t *stats) {
+    *stats = g_stats;
+    uint64_t elapsed = g_last - g_t0;
+    /* pierwszy krok wykonuje się w chwili t0 */
+    stats->steps_per_sec = (elapsed && g_stats.steps > 1)
+        ? (uint32_t)(((uint64_t)(g_stats.steps - 1) * 1000000u) / elapsed) : 0;
+}
@@ -0,0 +1,59 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Największa liczba punktów – obrazy rejestrów całego przemiatania są w RAM */
+#ifndef SWEEP_MAX_STEPS
+#define SWEEP_MAX_STEPS 512
+#endif
+
+typedef enum {
+    SWEEP_LINEAR = 0,
+    SWEEP_LOG
+} sweep_spacing_t;
+
+typedef enum {
+    SWEEP_ONCE = 0,     /* start -> stop i koniec */
+    SWEEP_REPEAT,       /* start -> stop, start -> stop, ... */
+    SWEEP_PINGPONG      /* start -> stop -> start -> ... */
+} sweep_repeat_t;
+
+typedef struct {
+    uint32_t start_hz;
+    uint32_t stop_hz;           /* może być mniejsze od start_hz (przemiatanie w dół) */
+    sweep_spacing_t spacing;
+    uint32_t step_hz;           /* SWEEP_LINEAR: krok w Hz */
+    uint16_t points_per_decade; /* SWEEP_LOG: liczba punktów na dekadę */
+    uint32_t dwell_us;          /* czas postoju na jednym punkcie */
+    sweep_repeat_t repeat;
+    int sync_gpio;              /* impuls na początku każdego przebiegu; -1 => brak */
+} sweep_config_t;
+
+typedef struct {
+    uint32_t steps;             /* wykonane kroki */
+    uint32_t steps_per_sec;     /* osiągnięta szybkość */
+    uint32_t max_jitter_us;     /* największe odchylenie kroku od harmonogramu */
+    uint32_t pll_resets;        /* kroki, które wymagały przestrojenia PLL */
+    uint32_t i2c_errors;
+} sweep_stats_t;
+
+/*
+ * Liczy wszystkie obrazy rejestrów z góry; punkty osiągalne z jednego VCO
+ * zmieniają tylko MS0. Zwraca liczbę punktów albo 0 przy błędzie, także gdy
+ * punktów (ze stop_hz włącznie) byłoby więcej niż SWEEP_MAX_STEPS.
+ */
+uint32_t sweep_prepare(const sweep_config_t *cfg);
+
+/*
+ * Przemiatanie działa z repeating_timer_t: każdy krok to jeden zapis obrazu
+ * przez I2C w przerwaniu. W tym czasie CLK0 należy do przemiatania –
+ * nie wołać si5351_clk0_set() przed sweep_stop().
+ */
+bool sweep_start(void);
+void sweep_stop(void);
+bool sweep_running(void);
+void sweep_get_stats(sweep_stats_t *stats);
+
+#endif
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Convert monochrome BMPs into page-native ssd1306_image_t tables.
+
+Input is a 1-bpp uncompressed .bmp file or a C header holding one (as image.h
+does). Pixels with the black palette entry are lit, matching
+ssd1306_bmp_show_image(). Output: one .c/.h pair, each image stored as
+ceil(height/8) pages of width bytes, LSB on top - the display RAM layout.
+
+Usage:
+    bmpconv.py -o OUT_BASENAME SPEC [SPEC ...]
+    SPEC = path/to/image.bmp|path/to/image.h[:name=C_NAME]
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+
+def load_bytes(path):
+    if not path.endswith(".h"):
+        return open(path, "rb").read()
+    text = open(path, encoding="utf-8", errors="replace").read()
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"//[^\n]*", "", text)
+    m = re.search(r"\[\s*\]\s*=\s*\{(.*?)\}", text, flags=re.S)
+    if not m:
+        sys.exit(f"{path}: no byte array found")
+    return bytes(int(v, 0) for v in re.findall(r"0[xX][0-9a-fA-F]+|\d+", m.group(1)))
+
+
+def convert(path, data):
+    if len(data) < 54 or data[:2] != b"BM":
+        sys.exit(f"{path}: not a BMP")
+    off_bits, = struct.unpack_from("<I", data, 10)
+    bi_size, width, height = struct.unpack_from("<Iii", data, 14)
+    bit_count, compression = struct.unpack_from("<HI", data, 28)
+    if bit_count != 1 or compression != 0:
+        sys.exit(f"{path}: only uncompressed 1-bpp images are supported")
+    if width > 255 or abs(height) > 255:
+        sys.exit(f"{path}: image larger than 255x255")
+
+    table = 14 + bi_size
+    lit = 0
+    for i in range(2):
+        if data[table + 4 * i:table + 4 * i + 3] == b"\0\0\0":
+            lit = i
+            break
+
+    stride = ((width + 31) // 32) * 4
+    rows = abs(height)
+    pages = (rows + 7) // 8
+    out = [0] * (pages * width)
+    for y in range(rows):
+        # bottom-up unless the height is negative
+        row = off_bits + (rows - 1 - y if height > 0 else y) * stride
+        for x in range(width):
+            if (data[row + (x >> 3)] >> (7 - (x & 7)) & 1) == lit:
+                out[(y >> 3) * width + x] |= 1 << (y & 7)
+    return width, rows, out
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-o", "--output", required=True, help="output path without extension")
+    ap.add_argument("specs", nargs="+")
+    args = ap.parse_args()
+
+    base = os.path.basename(args.output)
+    guard = re.sub(r"\W", "_", base).upper() + "_H"
+    src, hdr, names = [], [], set()
+
+    for spec in args.specs:
+        path, *opts = spec.split(":")
+        name = None
+        for opt in opts:
+            key, _, val = opt.partition("=")
+            if key == "name":
+                name = val
+            else:
+                sys.exit(f"{spec}: unknown option {key}")
+        name = name or re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+        if name in names:
+            sys.exit(f"{spec}: duplicate name {name}, use :name=")
+        names.add(name)
+
+        width, height, pixels = convert(path, load_bytes(path))
+        print(f"{name}: {width}x{height}, {len(pixels)} bytes")
+
+        hdr.append(f"extern const ssd1306_image_t {name};")
+        src.append(f"// {os.path.basename(path)}, {width}x{height}")
+        src.append(f"static const uint8_t {name}_data[] = {{")
+        for i in range(0, len(pixels), 16):
+            src.append("    " + ",".join(f"0x{v:02x}" for v in pixels[i:i + 16]) + ",")
+        src.append("};")
+        src.append(f"const ssd1306_image_t {name} = {{.width = {width}, .height = {height}, .data = {name}_data}};")
+        src.append("")
+
+    with open(args.output + ".h", "w") as fh:
+        fh.write(f"// Generated by tools/bmpconv.py - do not edit\n#ifndef {guard}\n#define {guard}\n\n")
+        fh.write('#include "ssd1306.h"\n\n' + "\n".join(hdr) + "\n\n#endif\n")
+    with open(args.output + ".c", "w") as fc:
+        fc.write(f'// Generated by tools/bmpconv.py - do not edit\n#include "{base}.h"\n\n')
+        fc.write("\n".join(src))
+
+
+if __name__ == "__main__":
+    main()
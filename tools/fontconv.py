@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""Convert the column-wise font headers into page-aligned ssd1306_pfont_t tables.
+
+Input format (font.h and friends):
+    <height>, <width>, <additional spacing per char>, <first ascii char>, <last ascii char>,
+    then per glyph <width> columns of ceil(height/8) bytes each, LSB on top.
+
+Output: one .c/.h pair holding a const ssd1306_pfont_t per requested font and
+scale. Glyphs are stored already scaled, each column as ceil(height*scale/8)
+page bytes, LSB on top. The smaller of two layouts is chosen per font:
+  fixed   - every glyph has the full width, no glyph table
+  trimmed - only the non-blank columns of each glyph (x offset + width in a
+            glyph table); with rle the glyph data is stored page by page and
+            run-length coded
+chars= keeps only the given characters, the others are drawn blank.
+
+Usage:
+    fontconv.py -o OUT_BASENAME SPEC [SPEC ...]
+    SPEC = path/to/font.h[:scale=N][:chars=STRING][:rle][:name=C_NAME]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+RLE_FLAG = 0x01
+STRUCT_BYTES = 20   # sizeof(ssd1306_pfont_t) on the RP2040
+GLYPH_BYTES = 4     # sizeof(ssd1306_pfont_glyph_t)
+
+
+def parse_font(path):
+    text = open(path, encoding="utf-8", errors="replace").read()
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"//[^\n]*", "", text)
+    m = re.search(r"(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\}", text, flags=re.S)
+    if not m:
+        sys.exit(f"{path}: no font array found")
+    values = [int(v, 0) for v in re.findall(r"0[xX][0-9a-fA-F]+|\d+", m.group(2))]
+    height, width, spacing, first, last = values[:5]
+    parts = (height >> 3) + (1 if height & 7 else 0)
+    data = values[5:]
+    count = last - first + 1
+    if len(data) < count * width * parts:
+        sys.exit(f"{path}: {len(data)} data bytes, expected {count * width * parts}")
+    glyphs = []
+    for g in range(count):
+        cols = []
+        for w in range(width):
+            base = (g * width + w) * parts
+            col = 0
+            for lp in range(parts):
+                col |= data[base + lp] << (8 * lp)
+            cols.append(col)
+        glyphs.append(cols)
+    return {
+        "name": m.group(1), "height": height, "width": width, "spacing": spacing,
+        "first": first, "last": last, "parts": parts, "glyphs": glyphs,
+        "source_bytes": 5 + len(data),
+    }
+
+
+def scale_column(col, bits, scale):
+    out = 0
+    for j in range(bits):
+        if col >> j & 1:
+            out |= ((1 << scale) - 1) << (j * scale)
+    return out
+
+
+def rle_encode(data):
+    """0x80|(n-1), b: n copies of b (n <= 128); n-1, b0..bn-1: n literal bytes."""
+    out = []
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 128:
+            run += 1
+        if run >= 3:
+            out += [0x80 | (run - 1), data[i]]
+            i += run
+            continue
+        j = i
+        while j < len(data) and j - i < 128:
+            if j + 2 < len(data) and data[j] == data[j + 1] == data[j + 2]:
+                break
+            j += 1
+        out += [j - i - 1] + data[i:j]
+        i = j
+    return out
+
+
+def glyph_columns(cols, bits, scale, pages):
+    out = []
+    for c in cols:
+        sc = scale_column(c, bits, scale)
+        out += [(sc >> (8 * k)) & 0xFF for k in range(pages)] * scale
+    return out
+
+
+def build(font, scale, chars, rle):
+    bits = font["parts"] * 8
+    pages = (font["height"] * scale + 7) // 8
+    first, last = font["first"], font["last"]
+    if chars:
+        codes = sorted({ord(c) for c in chars if first <= ord(c) <= last})
+        if not codes:
+            sys.exit(f"no characters of {chars!r} in the font")
+        first, last = codes[0], codes[-1]
+        keep = set(codes)
+    else:
+        keep = set(range(first, last + 1))
+
+    blank = [0] * font["width"]
+    glyphs = [font["glyphs"][code - font["first"]] if code in keep else blank
+              for code in range(first, last + 1)]
+
+    fixed = []
+    for cols in glyphs:
+        fixed += glyph_columns(cols, bits, scale, pages)
+
+    table, trimmed, max_glyph = [], [], 0
+    for cols in glyphs:
+        nz = [i for i, c in enumerate(cols) if c]
+        if not nz:
+            table.append((len(trimmed), 0, 0))
+            continue
+        x0, x1 = nz[0], nz[-1]
+        glyph = glyph_columns(cols[x0:x1 + 1], bits, scale, pages)
+        max_glyph = max(max_glyph, len(glyph))
+        table.append((len(trimmed), x0 * scale, (x1 - x0 + 1) * scale))
+        if rle:
+            # page-major, so horizontally scaled columns become byte runs
+            w = (x1 - x0 + 1) * scale
+            glyph = [glyph[col * pages + k] for k in range(pages) for col in range(w)]
+            glyph = rle_encode(glyph)
+        trimmed += glyph
+
+    result = {
+        "height": font["height"] * scale, "pages": pages,
+        "advance": (font["width"] + font["spacing"]) * scale,
+        "width": font["width"] * scale, "first": first, "last": last,
+    }
+    if not rle and len(fixed) <= len(trimmed) + GLYPH_BYTES * len(table):
+        result.update(flags=0, max_glyph=font["width"] * scale * pages, table=None, data=fixed)
+    else:
+        result.update(flags=RLE_FLAG if rle else 0, max_glyph=max_glyph, table=table, data=trimmed)
+    return result
+
+
+def c_bytes(values, indent="    ", per_line=16):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append(indent + ",".join(f"0x{v:02x}" for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("-o", "--output", required=True, help="output path without extension")
+    ap.add_argument("specs", nargs="+")
+    args = ap.parse_args()
+
+    base = os.path.basename(args.output)
+    guard = re.sub(r"\W", "_", base).upper() + "_H"
+    src, hdr, report, names = [], [], [], set()
+
+    for spec in args.specs:
+        path, *opts = spec.split(":")
+        scale, chars, rle, name = 1, None, False, None
+        for opt in opts:
+            key, _, val = opt.partition("=")
+            if key == "scale":
+                scale = int(val)
+            elif key == "chars":
+                chars = val
+            elif key == "rle":
+                rle = True
+            elif key == "name":
+                name = val
+            else:
+                sys.exit(f"{spec}: unknown option {key}")
+
+        font = parse_font(path)
+        name = name or f"{font['name']}_pf{scale}" + ("_rle" if rle else "")
+        if name in names:
+            sys.exit(f"{spec}: duplicate name {name}, use :name=")
+        names.add(name)
+        f = build(font, scale, chars, rle)
+        total = STRUCT_BYTES + GLYPH_BYTES * len(f["table"] or []) + len(f["data"])
+        layout = "fixed" if f["table"] is None else ("rle" if rle else "trimmed")
+        report.append(f"{name}: {font['source_bytes']} -> {total} bytes ({layout})")
+
+        hdr.append(f"extern const ssd1306_pfont_t {name};")
+        src.append(f"// {os.path.basename(path)}, scale {scale}"
+                   + (f", chars \"{chars}\"" if chars else "") + (", rle" if rle else ""))
+        if f["table"] is not None:
+            src.append(f"static const ssd1306_pfont_glyph_t {name}_glyphs[] = {{")
+            for off, x, w in f["table"]:
+                src.append(f"    {{{off}, {x}, {w}}},")
+            src.append("};")
+        src.append(f"static const uint8_t {name}_data[] = {{")
+        src.append(c_bytes(f["data"]) if f["data"] else "    0,")
+        src.append("};")
+        src.append(f"const ssd1306_pfont_t {name} = {{")
+        src.append(f"    .height = {f['height']}, .pages = {f['pages']}, .advance = {f['advance']},")
+        src.append(f"    .first = {f['first']}, .last = {f['last']}, .flags = {f['flags']},")
+        src.append(f"    .width = {f['width']}, .max_glyph = {f['max_glyph']},")
+        glyphs = f"{name}_glyphs" if f["table"] is not None else "NULL"
+        src.append(f"    .glyphs = {glyphs}, .data = {name}_data,")
+        src.append("};")
+        src.append("")
+
+    with open(args.output + ".h", "w") as fh:
+        fh.write(f"// Generated by tools/fontconv.py - do not edit\n#ifndef {guard}\n#define {guard}\n\n")
+        fh.write('#include "ssd1306.h"\n\n' + "\n".join(hdr) + f"\n\n#endif\n")
+    with open(args.output + ".c", "w") as fc:
+        fc.write(f'// Generated by tools/fontconv.py - do not edit\n#include "{base}.h"\n\n')
+        fc.write("\n".join(src))
+    for line in report:
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,29 @@
+#include "ui_screen.h"
+#include "fonts_pf.h"
+
+#define UI_MAX_DIGITS 16
+
+void ui_draw_frequency(ssd1306_t *p, const int *digits, int num_digits, int selected, bool editing) {
+    char digits_str[UI_MAX_DIGITS + 1];
+    if (num_digits > UI_MAX_DIGITS)
+        num_digits = UI_MAX_DIGITS;
+
+    for (int i = 0; i < num_digits; ++i)
+        digits_str[i] = digits[i] + '0';
+    digits_str[num_digits] = '\0';
+
+    ssd1306_clear(p);
+    ssd1306_draw_string_pfont(p, 5, 35, &digits_pf2, digits_str);
+
+    // Draw underline or box for selected digit
+    int char_width = 7 * 2; // font width * scale (adjust if needed)
+    int x = 5 + selected * char_width;
+    int y = 55;
+    if (editing) {
+        // Draw a box around the digit
+        ssd1306_draw_empty_square(p, x - 2, y - 20, char_width, 20);
+    } else {
+        // Draw underline
+        ssd1306_draw_hline(p, x, y, char_width - 4);
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef UI_SCREEN_H
+#define UI_SCREEN_H
+
+#include <stdbool.h>
+#include "ssd1306.h"
+
+// Frequency screen: one digit per entry of digits, the selected one underlined,
+// or boxed while it is being edited. Only touches the display buffer, so it
+// also runs on the host against the emulator (host/).
+void ui_draw_frequency(ssd1306_t *p, const int *digits, int num_digits, int selected, bool editing);
+
+#endif